@@ -8,6 +8,7 @@
 #include "confmodel/ResourceSet.hpp"
 #include "confmodel/Segment.hpp"
 #include "confmodel/Session.hpp"
+#include "confmodel/disabled-reason.hpp"
 
 #include <iostream>
 //#include <set>
@@ -16,55 +17,56 @@
 using namespace dunedaq;
 
 
+// explain why the object is disabled, e.g. "parent segment is disabled <- seg-1: disabled in session"
+std::string disabled_reason(const confmodel::Session* session,
+                            const confmodel::Component* obj) {
+  std::string reason;
+  for (const auto& step : obj->disabled_reason(*session)) {
+    if (reason.empty()) {
+      reason = confmodel::DisabledReason::str(step.m_cause);
+    }
+    else {
+      reason += " <- " + step.m_component->UID() + ": " + confmodel::DisabledReason::str(step.m_cause);
+    }
+  }
+  return reason;
+}
+
 void process_segment(const confmodel::Session* session,
                      const confmodel::Segment* segment,
-                     const std::set<std::string>& disabled_objects,
                      std::string spacer) {
   std::cout << spacer << "Segment " << segment->UID();
   bool segment_disabled = segment->disabled(*session);
-  std::string reason = "";
   if (segment_disabled) {
-    std::cout << " disabled";
-    reason = "segment";
+    std::cout << " <disabled: " << disabled_reason(session, segment) << ">";
   }
   std::cout << "\n";
   for (auto subseg : segment->get_segments()) {
-    process_segment (session, subseg, disabled_objects, spacer+"  ");
+    process_segment (session, subseg, spacer+"  ");
   }
 
   for (auto app : segment->get_applications()) {
-    bool disabled = segment_disabled;
     std::cout << spacer << "  Application: " << app->UID();
-    if (!disabled) {
-      auto rset = app->cast<confmodel::ResourceSet>();
-      if (rset) {
-        if (rset->disabled(*session)) {
-          disabled = true;
-          if (disabled_objects.find(app->UID()) != disabled_objects.end()) {
-            reason = "directly";
-          }
-          else {
-            reason = "due to state of related objects";
-          }
-        }
+    auto rset = app->cast<confmodel::ResourceSet>();
+    if (rset) {
+      if (!segment_disabled) {
         std::cout << " contains: {";
         std::string seperator = "";
         for (auto mod : rset->get_contains()) {
           std::cout << seperator << mod->UID();
           if (mod->disabled(*session)) {
-            std::cout << "<disabled ";
-            if (disabled_objects.find(mod->UID()) == disabled_objects.end()) {
-              std::cout << "in";
-            }
-            std::cout << "directly>";
+            std::cout << "<disabled: " << disabled_reason(session, mod) << ">";
           }
           seperator = ", ";
         }
         std::cout << "}";
       }
+      if (rset->disabled(*session)) {
+        std::cout << " <disabled: " << disabled_reason(session, rset) << ">";
+      }
     }
-    if (disabled) {
-      std::cout << " <disabled "<< reason << ">";
+    else if (segment_disabled) {
+      std::cout << " <disabled: parent segment is disabled>";
     }
     auto daqApp = app->cast<confmodel::DaqApplication>();
     if (daqApp) {
@@ -121,15 +123,7 @@ int main(int argc, char* argv[]) {
 
     std::cout << separator << "      Applications in Session: "
               << sessionName << "\n";
-    std::set<std::string> disabled_objects;
-    for (auto object : session->get_disabled()) {
-      TLOG_DEBUG(11) << object->UID() << " is in disabled list of Session";
-      disabled_objects.insert(object->UID());
-    }
-
-    process_segment (session, session->get_segment(),
-                     disabled_objects,
-                     "");
+    process_segment (session, session->get_segment(), "");
     separator =
       "\n   ----------------------------------------------\n\n";
   }
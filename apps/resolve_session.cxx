@@ -0,0 +1,62 @@
+#include "logging/Logging.hpp"
+
+#include "conffwk/Configuration.hpp"
+
+#include "confmodel/Session.hpp"
+#include "confmodel/resolved-session.hpp"
+#include "confmodel/session-index.hpp"
+#include "confmodel/util.hpp"
+
+#include <iostream>
+#include <string>
+
+using namespace dunedaq;
+
+int main(int argc, char* argv[]) {
+  const std::string program(argv[0]);
+  const bool index = (argc > 1 && std::string(argv[1]) == "--index");
+  if (index) {
+    --argc;
+    ++argv;
+  }
+
+  if (argc < 4) {
+    std::cout << "Usage: " << program << " [--index] session database-file output-file\n\n"
+                 "Writes the session with resolved applications, modules, connections, hosts, services,\n"
+                 "readout map and enabled state to a binary file. With --index writes the session index\n"
+                 "to be mapped by all processes of the host.\n";
+    return 1;
+  }
+
+  const std::string session_name(argv[1]);
+
+  dunedaq::logging::Logging::setup(session_name, "resolve-session");
+
+  try {
+    conffwk::Configuration db("oksconflibs:" + std::string(argv[2]));
+
+    auto session = db.get<confmodel::Session>(session_name);
+    if (session == nullptr) {
+      std::cerr << "Session " << session_name << " not found in database\n";
+      return 1;
+    }
+
+    if (index) {
+      confmodel::SessionIndex::write(db, *session, argv[3]);
+      std::cout << confmodel::SessionIndex(argv[3]).size() << " items written to " << argv[3] << std::endl;
+      return 0;
+    }
+
+    const auto resolved = confmodel::resolve_session(db, *session);
+    confmodel::write_resolved_session(resolved, std::string(argv[3]));
+
+    std::cout << resolved.m_applications.size() << " applications, " << resolved.m_modules.size() << " modules, "
+              << resolved.m_streams.size() << " detector streams written to " << argv[3] << std::endl;
+  }
+  catch (const ers::Issue& ex) {
+    std::cerr << "Failed to resolve session: " << ex << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,106 @@
+#ifndef DUNEDAQDAL_COMMAND_LINE_H
+#define DUNEDAQDAL_COMMAND_LINE_H
+
+#include "confmodel/environment.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dunedaq::confmodel {
+
+    class Application;
+    class Session;
+
+    /**
+     *  \brief Text with ${NAME} variable references parsed once into literal and variable segments.
+     *
+     *  \throw dunedaq::confmodel::BadVariableUsage, if a reference is not terminated or has empty name
+     */
+
+    class CommandLineTemplate
+    {
+
+    public:
+
+      explicit CommandLineTemplate(const std::string& text);
+
+      /// the template of the text compiled once per process; the reference is valid until the end of the process (thread-safe)
+      static const CommandLineTemplate&
+      get(const std::string& text);
+
+      /// the text with every variable replaced by the value returned by lookup(name); if lookup() returns
+      /// nullptr, the reference is kept as is
+      template<class F>
+      std::string
+      expand(F lookup) const
+      {
+        std::string result;
+        result.reserve(m_size);
+
+        for (const auto& s : m_segments) {
+          if (!s.m_is_variable) {
+            result.append(s.m_text);
+          }
+          else if (const std::string * value = lookup(s.m_text)) {
+            result.append(*value);
+          }
+          else {
+            result.append("${").append(s.m_text).append("}");
+          }
+        }
+
+        return result;
+      }
+
+      bool
+      has_variables() const noexcept
+      {
+        return m_has_variables;
+      }
+
+    private:
+
+      struct Segment
+      {
+        bool m_is_variable;
+        std::string m_text;
+      };
+
+      std::vector<Segment> m_segments;
+      std::size_t m_size = 0;          // of literals, to reserve the result
+      bool m_has_variables = false;
+    };
+
+    /**
+     *  \brief Expands commandline_parameters of applications.
+     *
+     *  A variable is taken from the application's environment (see EnvironmentResolver), then from the session
+     *  attributes (DUNEDAQ_SESSION and DUNEDAQ_PARTITION are the session UID) and then from the process
+     *  environment; references to undefined variables are kept. Values are substituted as defined, variables
+     *  referenced by them are not expanded. Every distinct parameter text is compiled once per process
+     *  (see CommandLineTemplate::get()), the environments are resolved once during the lifetime of the expander.
+     */
+
+    class CommandLineExpander
+    {
+
+    public:
+
+      /// without session, only the process environment is used
+      explicit CommandLineExpander(const Session * session);
+
+      /// \throw dunedaq::confmodel::BadVariableUsage, dunedaq::confmodel::FoundCircularDependency or dunedaq::conffwk::Exception
+      std::vector<std::string>
+      expand(const Application& app);
+
+    private:
+
+      std::unique_ptr<EnvironmentResolver> m_environment;
+      EnvironmentResolver::Environment m_session_variables;
+      EnvironmentResolver::Environment m_process_variables;
+    };
+
+} // namespace dunedaq::confmodel
+
+#endif // DUNEDAQDAL_COMMAND_LINE_H
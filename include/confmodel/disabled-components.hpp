@@ -1,55 +1,190 @@
 #ifndef DUNEDAQDAL_DISABLED_COMPONENTS_H
 #define DUNEDAQDAL_DISABLED_COMPONENTS_H
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "conffwk/Configuration.hpp"
 #include "conffwk/ConfigAction.hpp"
 
 #include "confmodel/Component.hpp"
+#include "confmodel/disabled-reason.hpp"
 
 namespace dunedaq::confmodel {
 
+    class Application;
+    class DetectorStream;
     class Session;
     class ResourceSet;
+    class ResourceSetAND;
+    class ResourceSetOR;
     // class Segment;
+    class DisabledSnapshot;
+
+    /// enabled applications (in Session::get_enabled_applications() order) and detector streams
+    /// of the session, if a candidate set of components was disabled in addition
+    struct WhatIfResult
+    {
+      std::vector<const dunedaq::confmodel::Application *> m_enabled_applications;
+      std::vector<const dunedaq::confmodel::DetectorStream *> m_enabled_streams;
+    };
 
     class DisabledComponents : public dunedaq::conffwk::ConfigAction
     {
 
       friend class Session;
       friend class Component;
+      friend class DisabledSnapshot;
 
     private:
 
-      struct SortStringPtr
+        // component of the session graph; the dense index of the node is used to access its state;
+        // the classes of the component are tested once, when the node is created
+
+      struct Node
+      {
+        enum Kind : std::uint8_t { other, resource_set, segment };
+
+        enum Type : std::uint16_t {
+          is_segment = 0x1,
+          is_application = 0x2,
+          is_resource = 0x4,
+          is_resource_set = 0x8,
+          is_resource_set_and = 0x10,
+          is_resource_set_or = 0x20,
+          is_det_data_sender = 0x40,
+          is_detector_stream = 0x80,
+          is_d2d_connection = 0x100
+        };
+
+        const dunedaq::confmodel::Component * m_obj;
+        Kind m_kind;
+        std::uint16_t m_type;                        // bitwise OR of Type values
+        bool m_expanded;
+        std::int32_t m_set;                          // index in m_sets for resource-set-OR/AND, or -1
+        std::vector<std::uint32_t> m_children;       // resource set contains, or segment applications and segments
+        std::vector<std::uint32_t> m_parents;        // reverse of m_children, used to walk up to the session's segment
+        std::vector<std::uint32_t> m_contained_by;   // indices in m_sets
+        std::vector<std::pair<const dunedaq::confmodel::Application *, std::uint32_t>> m_applications; // segment applications and their nodes (npos, if not a component)
+
+        // the graph is followed the same way by all algorithms: from a segment to nested segments
+        // and resource set applications, from a resource set to nested resource sets
+        static bool
+        is_followed(Kind from, Kind to)
+        {
+          return (to == resource_set || (to == segment && from == segment));
+        }
+      };
+
+        // resource-set-OR or resource-set-AND taking part in the disabled state propagation
+
+      struct SetInfo
+      {
+        std::uint32_t m_node;
+        bool m_is_and;
+      };
+
+        // explicitly disabled component
+
+      struct Seed
+      {
+        std::uint32_t m_node;
+        DisabledReason::Cause m_cause;
+      };
+
+        // state of a published snapshot with more components disabled (what-if evaluation)
+
+      class Overlay;
+
+        // session graph; it depends on the database only and survives the user disabled/enabled changes;
+        // once used by a published snapshot or returned by get_graph() it is never modified (a copy is
+        // extended instead); it is rebuilt on next use after database changes affecting the session
+
+      struct Graph
       {
-        bool
-        operator()(const std::string * s1, const std::string * s2) const
+        static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+
+        std::vector<Node> m_nodes;
+        std::unordered_map<const dunedaq::conffwk::ConfigObjectImpl *, std::uint32_t> m_index;
+        std::vector<SetInfo> m_sets;
+        std::shared_ptr<const std::vector<const dunedaq::confmodel::Application *>> m_applications; // all session applications, shared by extended copies
+
+        std::uint32_t
+        find(const dunedaq::confmodel::Component * c) const
         {
-          return (*s1 < *s2);
+          auto it = m_index.find(c->config_object().implementation());
+          return (it == m_index.end() ? npos : it->second);
         }
       };
 
       dunedaq::conffwk::Configuration& m_db;
       Session* m_session;
 
+        // the members below are protected by the mutex; only m_snapshot is read without it
+
+      std::mutex m_mutex;
+
       unsigned long m_num_of_slr_enabled_resources;
       unsigned long m_num_of_slr_disabled_resources;
 
-      std::set<const std::string *, SortStringPtr> m_disabled;
       std::set<const dunedaq::confmodel::Component *> m_user_disabled;
       std::set<const dunedaq::confmodel::Component *> m_user_enabled;
 
+      std::shared_ptr<Graph> m_graph;
+      bool m_graph_published;
+      bool m_computed;
+
+      std::vector<std::uint8_t> m_disabled;
+      std::vector<std::uint8_t> m_closed; // disabled containers, which children are disabled too
+      std::vector<std::uint8_t> m_reason; // DisabledReason::Cause of disabled components
+      std::vector<std::uint32_t> m_cause; // component which disabled given one, or npos for explicitly disabled
+      std::size_t m_num_of_disabled;
+      std::vector<std::size_t> m_num_of_enabled; // per m_sets entry, number of not yet disabled "contains" (AND only)
+      std::vector<std::uint32_t> m_worklist;
+      std::vector<std::uint8_t> m_mark; // scratch space of repropagate(), always zeroed
+
+        // published result, accessed via std::atomic_load / std::atomic_store only
+
+      std::shared_ptr<const DisabledSnapshot> m_snapshot;
+
+        // incremented on any change of the user disabled/enabled components or of the database
+
+      std::atomic<std::uint64_t> m_generation;
+
+        // session object was changed; its disabled components are compared with previous ones on next use
+
+      bool m_session_changed;
+      std::vector<std::uint32_t> m_session_seeds; // sorted nodes of the session disabled components
+
+        // enabled applications calculated for given generation
+
+      std::shared_ptr<const std::vector<const dunedaq::confmodel::Application *>> m_enabled_applications;
+      std::uint64_t m_enabled_applications_generation;
+
+        // names of classes which objects define the session graph, and of all component classes
+
+      std::set<std::string> m_session_classes;
+      std::set<std::string> m_container_classes;
+      std::set<std::string> m_component_classes;
+
       void
       __clear() noexcept
       {
-        m_disabled.clear();
         m_user_disabled.clear();
         m_user_enabled.clear();
         m_num_of_slr_enabled_resources = 0;
         m_num_of_slr_disabled_resources = 0;
+
+        drop_graph();
       }
 
     public:
@@ -60,7 +195,7 @@ namespace dunedaq::confmodel {
       ~DisabledComponents();
 
       void
-      notify(std::vector<dunedaq::conffwk::ConfigurationChange *>& /*changes*/) noexcept;
+      notify(std::vector<dunedaq::conffwk::ConfigurationChange *>& changes) noexcept;
 
       void
       load() noexcept;
@@ -75,32 +210,190 @@ namespace dunedaq::confmodel {
       reset() noexcept;
 
       size_t
-      size() noexcept
+      size() noexcept;
+
+      static unsigned long
+      get_num_of_slr_resources(const dunedaq::confmodel::Session& p);
+
+    private:
+
+      /// get published result, calculate it if there is none (thread-safe)
+      std::shared_ptr<const DisabledSnapshot>
+      get_snapshot();
+
+      void
+      publish();
+
+      void
+      invalidate() noexcept;
+
+      void
+      drop_graph() noexcept;
+
+      void
+      mark_session_changed() noexcept;
+
+      void
+      init_classes();
+
+      bool
+      in_graph(const std::set<std::string>& uids) const;
+
+      std::vector<std::uint32_t>
+      get_session_seeds();
+
+      void
+      apply_session_changes();
+
+      Graph&
+      mutable_graph();
+
+      std::uint32_t
+      get_node(const dunedaq::confmodel::Component& c);
+
+      void
+      expand(std::uint32_t id);
+
+      void
+      add_to_graph(std::uint32_t id);
+
+      void
+      add_set(std::uint32_t id, bool is_and);
+
+      void
+      build_graph();
+
+      std::vector<std::uint32_t>
+      find_sets() const;
+
+      /// get the session graph, build it if there is none (thread-safe)
+      std::shared_ptr<const Graph>
+      get_graph();
+
+      /// visit session applications in order of segments until the visitor returns false; the top segment is not tested
+      template<class F, class V>
+      static bool
+      visit_applications(const Graph& graph, std::uint32_t id, F is_disabled, V& visitor);
+
+      /// the list is shared and never changed; a change of the disabled state or of the database creates a new one
+      std::shared_ptr<const std::vector<const dunedaq::confmodel::Application *>>
+      get_applications(bool enabled_only);
+
+      void
+      for_each_application(const std::function<bool(const dunedaq::confmodel::Application&)>& visitor, bool enabled_only);
+
+      void
+      get_parents(const dunedaq::confmodel::Component& c, std::list<std::vector<const dunedaq::confmodel::Component *>>& parents);
+
+      void
+      get_all_parents(std::unordered_map<const dunedaq::confmodel::Component *, std::list<std::vector<const dunedaq::confmodel::Component *>>>& parents);
+
+      std::vector<Seed>
+      get_seeds();
+
+      // newly disabled components are queued for propagation to their OR/AND containers;
+      // the first reached cause is kept as the explanation
+      void
+      disable(std::uint32_t id, DisabledReason::Cause reason, std::uint32_t cause)
       {
-        return m_disabled.size();
+        if (m_disabled[id] == 0) {
+          m_disabled[id] = 1;
+          m_reason[id] = reason;
+          m_cause[id] = cause;
+          m_num_of_disabled++;
+          m_worklist.push_back(id);
+        }
       }
 
       void
-      disable(const dunedaq::confmodel::Component& c)
+      disable_children(std::uint32_t id);
+
+      void
+      seed(const Seed& s);
+
+      void
+      propagate();
+
+      /// calculate disabled components of the session from scratch
+      void
+      compute();
+
+      /// recalculate disabled state of changed components, their descendants and OR/AND sets depending on them
+      void
+      repropagate(const std::vector<const dunedaq::confmodel::Component *>& changed);
+
+      /// evaluate candidates in parallel using overlays of the current state
+      std::vector<WhatIfResult>
+      evaluate(const std::vector<std::set<const dunedaq::confmodel::Component *>>& candidates);
+
+    };
+
+    /**
+     *  \brief Immutable enabled/disabled state of a session's components.
+     *
+     *  The snapshot is calculated by the Session::get_disabled_snapshot() method and may be kept and
+     *  queried without locking by any thread for as long as needed. It is not affected by later changes;
+     *  compare its generation with Session::get_disabled_generation() to check whether it is stale.
+     */
+
+    class DisabledSnapshot
+    {
+
+      friend class DisabledComponents;
+      friend class DisabledComponents::Overlay;
+
+    public:
+
+      /// value of the session's generation counter this state was calculated for
+      std::uint64_t
+      generation() const noexcept
+      {
+        return m_generation;
+      }
+
+      /// number of disabled components
+      std::size_t
+      size() const noexcept
       {
-        m_disabled.insert(&c.UID());
+        return m_num_of_disabled;
       }
 
       bool
-      is_enabled(const dunedaq::confmodel::Component* c) {
-        return (m_disabled.find(&c->UID()) == m_disabled.end());
+      is_disabled(const dunedaq::confmodel::Component& c) const
+      {
+        if (m_graph) {
+          const std::uint32_t id = m_graph->find(&c);
+          return (id != DisabledComponents::Graph::npos && m_disabled[id] != 0);
+        }
+        return false;
       }
 
-      void
-      disable_children(const dunedaq::confmodel::ResourceSet&);
+      bool
+      is_enabled(const dunedaq::confmodel::Component& c) const
+      {
+        return !is_disabled(c);
+      }
 
-      void
-      disable_children(const dunedaq::confmodel::Segment&);
+      /// explanation why the component is disabled, see DisabledReason; empty, if it is enabled
+      std::vector<DisabledReason>
+      get_reason(const dunedaq::confmodel::Component& c) const;
 
-      static unsigned long
-      get_num_of_slr_resources(const dunedaq::confmodel::Session& p);
+      /// true, if the session's disabled state was changed since the snapshot was taken
+      bool
+      is_stale(const dunedaq::confmodel::Session& session) const;
+
+    private:
+
+      std::shared_ptr<const DisabledComponents::Graph> m_graph; // null, if the session has no disabled components
+      std::vector<std::uint8_t> m_disabled;
+      std::vector<std::uint8_t> m_closed;
+      std::vector<std::uint8_t> m_reason;
+      std::vector<std::uint32_t> m_cause;
+      std::size_t m_num_of_disabled = 0;
+      std::uint64_t m_generation = 0;
 
     };
+
 } // namespace dunedaq::confmodel
 
 #endif // DUNEDAQDAL_DISABLED_COMPONENTS_H
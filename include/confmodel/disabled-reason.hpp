@@ -0,0 +1,59 @@
+#ifndef DUNEDAQDAL_DISABLED_REASON_H
+#define DUNEDAQDAL_DISABLED_REASON_H
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace dunedaq::confmodel {
+
+    class Component;
+
+    /**
+     *  \brief One step of the explanation why a component is disabled.
+     *
+     *  The Component::disabled_reason() method returns a chain of such steps: the first one is
+     *  the component itself, every next one is the component which caused the previous one to
+     *  be disabled, and the last one is a component disabled explicitly by user or in the session.
+     */
+
+    struct DisabledReason
+    {
+      enum Cause : std::uint8_t {
+        enabled,                // not disabled
+        user_disabled,          // disabled by user via Session::set_disabled() or Session::disable_more()
+        session_disabled,       // in the session's "disabled" relationship
+        parent_segment,         // the segment containing it is disabled
+        parent_resource_set,    // the resource set containing it is disabled
+        or_child,               // resource-set-OR with a disabled child
+        and_children            // resource-set-AND with all children disabled; next step is the last disabled child
+      };
+
+      const dunedaq::confmodel::Component * m_component;
+      Cause m_cause;
+
+      static const char *
+      str(Cause cause) noexcept
+      {
+        switch (cause) {
+          case enabled:             return "enabled";
+          case user_disabled:       return "disabled by user";
+          case session_disabled:    return "disabled in session";
+          case parent_segment:      return "parent segment is disabled";
+          case parent_resource_set: return "parent resource set is disabled";
+          case or_child:            return "a child of resource-set-OR is disabled";
+          case and_children:        return "all children of resource-set-AND are disabled";
+        }
+        return "unknown";
+      }
+    };
+
+    inline std::ostream&
+    operator<<(std::ostream& s, DisabledReason::Cause cause)
+    {
+      return s << DisabledReason::str(cause);
+    }
+
+} // namespace dunedaq::confmodel
+
+#endif // DUNEDAQDAL_DISABLED_REASON_H
@@ -0,0 +1,80 @@
+#ifndef DUNEDAQDAL_ENVIRONMENT_H
+#define DUNEDAQDAL_ENVIRONMENT_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace dunedaq::conffwk {
+    class ConfigObjectImpl;
+}
+
+namespace dunedaq::confmodel {
+
+    class Application;
+    class Session;
+    class VariableBase;
+    class VariableSet;
+
+    /**
+     *  \brief Process environment of applications defined by the session and application variables.
+     *
+     *  A list of variables is flattened depth-first into nested variable sets. If a name is defined several
+     *  times, the first definition is used. The application environment takes precedence over the session one,
+     *  i.e. a variable defined by both has the value from Application.application_environment.
+     *
+     *  Every variable set is flattened once during the lifetime of the resolver; applications using the same
+     *  list of variables share the same environment object. A variable set containing itself directly or
+     *  indirectly is reported by the dunedaq::confmodel::FoundCircularDependency exception.
+     */
+
+    class EnvironmentResolver
+    {
+
+    public:
+
+      using Environment = std::map<std::string, std::string>;
+
+      explicit EnvironmentResolver(const Session& session) :
+        m_session(session)
+      {
+        ;
+      }
+
+      /// \throw dunedaq::confmodel::FoundCircularDependency or dunedaq::conffwk::Exception
+      std::shared_ptr<const Environment>
+      get_session_environment();
+
+      /// the session environment with the application's variables; the application may be e.g. a controller
+      /// \throw dunedaq::confmodel::FoundCircularDependency or dunedaq::conffwk::Exception
+      std::shared_ptr<const Environment>
+      get_environment(const Application& app);
+
+      /// environments of all enabled applications of the session (Session::get_enabled_applications() order)
+      /// \throw dunedaq::confmodel::FoundCircularDependency or dunedaq::conffwk::Exception
+      std::vector<std::pair<const Application *, std::shared_ptr<const Environment>>>
+      get_environments();
+
+    private:
+
+      using Key = std::vector<const dunedaq::conffwk::ConfigObjectImpl *>;
+
+      void
+      add(const std::vector<const VariableBase *>& variables, Environment& env);
+
+      const Environment&
+      flatten(const VariableSet& set);
+
+      const Session& m_session;
+      std::shared_ptr<const Environment> m_session_environment;
+      std::map<Key, std::shared_ptr<const Environment>> m_environments;              // by application variables
+      std::unordered_map<const dunedaq::conffwk::ConfigObjectImpl *, Environment> m_sets;  // flattened variable sets
+      std::vector<const VariableSet *> m_path;                                         // sets being flattened
+    };
+
+} // namespace dunedaq::confmodel
+
+#endif // DUNEDAQDAL_ENVIRONMENT_H
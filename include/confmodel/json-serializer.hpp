@@ -0,0 +1,184 @@
+#ifndef DUNEDAQDAL_JSON_SERIALIZER_H
+#define DUNEDAQDAL_JSON_SERIALIZER_H
+
+#include <limits>
+#include <ostream>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "conffwk/ConfigObject.hpp"
+#include "conffwk/Configuration.hpp"
+
+#include "nlohmann/json.hpp"
+
+namespace dunedaq::confmodel {
+
+    class Session;
+
+    /**
+     *  \brief Options of the JSON serialization of configuration objects.
+     *
+     *  By default an object is serialized as {"uid": {"attribute": value, ..., "relationship": {"uid": {...}}}}
+     *  with all referenced objects inlined, as Jsonable::to_json() always did. Relationships which are not
+     *  followed are omitted; objects of excluded classes are omitted from relationship values.
+     *  With references, an object first met at a limited depth is referenced with the same contents.
+     */
+
+    struct JsonOptions
+    {
+      static constexpr unsigned int unlimited = std::numeric_limits<unsigned int>::max();
+
+      bool m_direct_only = false;    // attributes only, no relationships
+      bool m_references = false;     // every object is serialized once, its next occurrences are {"$ref": "uid@class"}
+
+      // projection: relationships and objects not needed are not read from the database
+
+      unsigned int m_max_depth = unlimited;         // levels of followed relationships; 0 means attributes only
+      std::set<std::string> m_relationships;        // if not empty, follow only these dot-separated paths, e.g. "modules.used_resources"
+      std::set<std::string> m_include_classes;      // if not empty, serialize only referenced objects of these classes or their subclasses
+      std::set<std::string> m_exclude_classes;      // do not serialize referenced objects of these classes or their subclasses
+      std::set<std::string> m_include_attributes;   // if not empty, serialize only these attributes
+      std::set<std::string> m_exclude_attributes;   // do not serialize these attributes
+    };
+
+    /**
+     *  \brief Serializer of configuration objects and of objects referenced by them.
+     *
+     *  Within the lifetime of the serializer every object is read from the database once and
+     *  every class description is processed once, so exporting many objects with one serializer is
+     *  cheaper than calling Jsonable::to_json() for each; with inlined output, the JSON of an object
+     *  referenced several times is copied from a cache.
+     *  A circular dependency between relationships of inlined objects is reported by the
+     *  dunedaq::confmodel::FoundCircularDependency exception; with references it is not an error.
+     */
+
+    class JsonSerializer
+    {
+
+    public:
+
+      JsonSerializer(dunedaq::conffwk::Configuration& db, const JsonOptions& options);
+
+      /// \throw dunedaq::conffwk::Exception or dunedaq::confmodel::FoundCircularDependency
+      nlohmann::json
+      serialize(const dunedaq::conffwk::ConfigObject& obj);
+
+      /// write the same JSON as serialize(obj).dump(indent) without building it in memory; negative indent means compact output;
+      /// the level is the indentation of the object, if it is nested into another JSON value
+      /// \throw dunedaq::conffwk::Exception or dunedaq::confmodel::FoundCircularDependency
+      void
+      write(const dunedaq::conffwk::ConfigObject& obj, std::ostream& out, int indent = -1, unsigned int level = 0);
+
+      /// make the next serialize() or write() forget objects serialized before; the cache of inlined objects is kept
+      void
+      reset_references() noexcept
+      {
+        m_serialized.clear();
+      }
+
+    private:
+
+        // how to serialize objects of a class: typed accessor of every attribute and relationships,
+        // prepared once from the class description
+
+      struct ClassPlan
+      {
+        struct Attribute
+        {
+          std::string m_name;
+          bool m_is_multi_value;
+          void (*m_add)(dunedaq::conffwk::ConfigObject&, const std::string&, bool, nlohmann::json&);
+        };
+
+        struct Relationship
+        {
+          std::string m_name;
+          bool m_is_single_value;
+        };
+
+        std::vector<Attribute> m_attributes;
+        std::vector<Relationship> m_relationships;
+        std::vector<std::pair<bool, std::size_t>> m_keys; // attributes (true) and relationships in order of JSON object keys
+        bool m_included;                                  // objects of the class are projected
+      };
+
+      const ClassPlan&
+      get_plan(const std::string& class_name);
+
+      nlohmann::json
+      get_value(dunedaq::conffwk::ConfigObject& obj);
+
+      nlohmann::json
+      get_attributes(dunedaq::conffwk::ConfigObject& obj);
+
+      bool
+      enter(dunedaq::conffwk::ConfigObject& obj);
+
+      bool
+      follow_relationships() const
+      {
+        return (!m_options.m_direct_only && m_path.size() <= m_options.m_max_depth);
+      }
+
+      bool
+      push_relationship(const std::string& name);
+
+      void
+      pop_relationship();
+
+      bool
+      is_included(const dunedaq::conffwk::ConfigObject& obj);
+
+      void
+      newline(std::ostream& out, int indent, unsigned int level) const;
+
+      void
+      write_value(dunedaq::conffwk::ConfigObject& obj, std::ostream& out, int indent, unsigned int level);
+
+      void
+      write_attributes(dunedaq::conffwk::ConfigObject& obj, std::ostream& out, int indent, unsigned int level);
+
+      dunedaq::conffwk::Configuration& m_db;
+      const JsonOptions m_options;
+      const bool m_use_cache;
+      std::set<std::string> m_paths;                // projected relationship paths and their prefixes
+      std::string m_relationship_path;              // path of the current object
+
+      std::unordered_map<std::string, ClassPlan> m_plans;
+      std::unordered_map<const dunedaq::conffwk::ConfigObjectImpl *, nlohmann::json> m_cache; // inlined objects
+      std::unordered_set<const dunedaq::conffwk::ConfigObjectImpl *> m_serialized;            // referenced objects
+      std::vector<dunedaq::conffwk::ConfigObject> m_path;
+
+    };
+
+    /**
+     *  \brief Serialize the whole session using several threads.
+     *
+     *  The result is {"applications": [...], "modules": [...], "segments": [...], "session": {...}} with
+     *  all applications of the session (Session::get_all_applications() order), modules of DAQ applications
+     *  (in order of applications, each once), segments (depth-first from the session's segment, each once)
+     *  and the session attributes. Every item is serialized independently, as Jsonable::to_json_with_options()
+     *  does, by a pool of threads reading the database concurrently; the result does not depend on the number
+     *  of threads.
+     *
+     *  \param db              configuration object of the session
+     *  \param session         the session object
+     *  \param options         serialization options of every item (the session is always serialized without relationships)
+     *  \param num_of_threads  size of the pool; if 0, the number of hardware threads is used
+     *
+     *  \throw dunedaq::conffwk::Exception or dunedaq::confmodel::FoundCircularDependency
+     */
+
+    nlohmann::json
+    export_session(dunedaq::conffwk::Configuration& db, const Session& session, const JsonOptions& options, unsigned int num_of_threads = 0);
+
+    /// write the same JSON as export_session(db, session, options, num_of_threads).dump(indent)
+    void
+    write_session(dunedaq::conffwk::Configuration& db, const Session& session, std::ostream& out, const JsonOptions& options, int indent = -1, unsigned int num_of_threads = 0);
+
+} // namespace dunedaq::confmodel
+
+#endif // DUNEDAQDAL_JSON_SERIALIZER_H
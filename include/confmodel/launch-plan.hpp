@@ -0,0 +1,87 @@
+#ifndef DUNEDAQDAL_LAUNCH_PLAN_H
+#define DUNEDAQDAL_LAUNCH_PLAN_H
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace dunedaq::conffwk {
+    class Configuration;
+}
+
+namespace dunedaq::confmodel {
+
+    class Application;
+    class CommandLineExpander;
+    class Session;
+
+    /**
+     *  \brief Command lines of all applications of the session to be started.
+     *
+     *  The plan contains the infrastructure applications of the session followed by controllers and enabled
+     *  applications of enabled segments, depth-first from the session's segment. The arguments of DAQ and
+     *  run control applications are made by the same functions of util.hpp as their construct_commandline_parameters()
+     *  methods use; the arguments of other applications are their expanded commandline_parameters
+     *  (see CommandLineExpander).
+     *
+     *  Strings are stored once in the plan (e.g. session UID, configuration URI, host names and executables);
+     *  entries refer to them, so the views are valid during lifetime of the plan.
+     */
+
+    class LaunchPlan
+    {
+
+    public:
+
+      struct Entry
+      {
+        const Application * m_application;
+        std::string_view m_executable;           // application_name
+        std::string_view m_host;                 // physical host
+        std::string_view m_control_uri;          // empty, if the application has no control service
+        std::vector<std::string_view> m_arguments;
+
+        std::vector<std::string>
+        get_arguments() const
+        {
+          return std::vector<std::string>(m_arguments.begin(), m_arguments.end());
+        }
+      };
+
+      /// \throw dunedaq::conffwk::Exception, dunedaq::confmodel::NoControlServiceDefined, if a DAQ or run control application has no control service,
+      /// or dunedaq::confmodel::BadVariableUsage
+      LaunchPlan(const dunedaq::conffwk::Configuration& confdb, const Session& session);
+
+      LaunchPlan(const LaunchPlan&) = delete;
+      LaunchPlan& operator=(const LaunchPlan&) = delete;
+      LaunchPlan(LaunchPlan&&) = default;
+      LaunchPlan& operator=(LaunchPlan&&) = default;
+
+      const std::vector<Entry>&
+      get_entries() const noexcept
+      {
+        return m_entries;
+      }
+
+    private:
+
+      std::string_view
+      intern(std::string_view s);
+
+      void
+      add(const Application& app, CommandLineExpander& expander);
+
+      std::deque<std::string> m_strings;            // elements are never moved
+      std::unordered_set<std::string_view> m_index;
+      std::vector<Entry> m_entries;
+
+      std::string_view m_session_id;
+      std::string_view m_configuration_uri;
+      std::string_view m_controller_log_level;
+    };
+
+} // namespace dunedaq::confmodel
+
+#endif // DUNEDAQDAL_LAUNCH_PLAN_H
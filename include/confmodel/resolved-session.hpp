@@ -0,0 +1,174 @@
+#ifndef DUNEDAQDAL_RESOLVED_SESSION_H
+#define DUNEDAQDAL_RESOLVED_SESSION_H
+
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace dunedaq::conffwk {
+    class Configuration;
+}
+
+namespace dunedaq::confmodel {
+
+    class Session;
+
+    /**
+     *  \brief Session with resolved relationships and enabled state, independent of the configuration database.
+     *
+     *  Objects are stored in tables; relationships between them are indices into the tables
+     *  (npos, if a single-value relationship is not set). Every object is stored once, even if it is
+     *  referenced several times. The enabled state is the one calculated by the session at resolution time.
+     */
+
+    struct ResolvedSession
+    {
+      static constexpr std::uint32_t format_version = 2;   // version of the binary format written by write_resolved_session()
+      static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+
+      /// version of the confmodel package (and of its dunedaq.schema.xml) this library was built from
+      static std::string
+      get_schema_version();
+
+      struct Service
+      {
+        std::string m_uid;
+        std::string m_protocol;
+        std::uint16_t m_port;
+        std::string m_eth_device_name;
+        std::string m_path;
+      };
+
+      struct Host                        // VirtualHost
+      {
+        std::string m_uid;
+        std::string m_physical_host;
+      };
+
+      struct Connection                  // Queue or NetworkConnection
+      {
+        std::string m_uid;
+        std::string m_class;
+        std::string m_data_type;
+        std::uint32_t m_service;         // associated service of a network connection
+      };
+
+      struct Module
+      {
+        std::string m_uid;
+        std::string m_class;
+        bool m_enabled;
+        std::vector<std::uint32_t> m_inputs;
+        std::vector<std::uint32_t> m_outputs;
+      };
+
+      struct Application
+      {
+        std::string m_uid;
+        std::string m_class;
+        std::string m_application_name;
+        std::vector<std::string> m_commandline_parameters;
+        bool m_enabled;
+        std::uint32_t m_host;
+        std::vector<std::uint32_t> m_services;
+        std::vector<std::uint32_t> m_modules;
+      };
+
+      struct Segment
+      {
+        std::string m_uid;
+        bool m_enabled;
+        std::uint32_t m_controller;
+        std::vector<std::uint32_t> m_segments;
+        std::vector<std::uint32_t> m_applications;
+      };
+
+      // the readout map
+
+      struct Stream
+      {
+        std::string m_uid;
+        std::uint32_t m_source_id;
+        std::uint32_t m_detector_id;
+        std::uint32_t m_crate_id;
+        std::uint32_t m_slot_id;
+        std::uint32_t m_stream_id;
+        bool m_enabled;
+      };
+
+      struct Sender
+      {
+        std::string m_uid;
+        std::string m_class;
+        bool m_enabled;
+        std::vector<std::uint32_t> m_streams;
+      };
+
+      struct ReadoutConnection           // DetectorToDaqConnection
+      {
+        std::string m_uid;
+        bool m_enabled;
+        std::string m_receiver;
+        std::string m_receiver_class;
+        bool m_receiver_enabled;
+        std::vector<std::uint32_t> m_senders;
+      };
+
+      std::string m_uid;
+      std::string m_schema_version;                  // get_schema_version() at resolution time
+      std::string m_source;                          // spec of the configuration database the session was resolved from
+      std::uint32_t m_segment = npos;                  // the session's segment
+
+      std::vector<Service> m_services;
+      std::vector<Host> m_hosts;
+      std::vector<Connection> m_connections;
+      std::vector<Module> m_modules;
+      std::vector<Application> m_applications;       // applications of segments, controllers and infrastructure applications
+      std::vector<Segment> m_segments;               // depth-first from the session's segment
+      std::vector<Stream> m_streams;
+      std::vector<Sender> m_senders;
+      std::vector<ReadoutConnection> m_readout_connections;
+    };
+
+    /**
+     *  \brief Resolve all applications, modules, connections, hosts, services and readout map of the session.
+     *
+     *  \throw dunedaq::conffwk::Exception or dunedaq::confmodel::ConfigurationError
+     */
+
+    ResolvedSession
+    resolve_session(const dunedaq::conffwk::Configuration& db, const Session& session);
+
+    /**
+     *  \brief Write the resolved session in CBOR format.
+     *
+     *  The top-level CBOR map contains the format name and version, the schema version, the database spec and
+     *  the session UID followed by the object tables; every object is an array of its fields, class names are
+     *  stored once.
+     *
+     *  \throw dunedaq::confmodel::BadResolvedSession on output errors
+     */
+
+    void
+    write_resolved_session(const ResolvedSession& session, std::ostream& out);
+
+    /// The caller compares m_source and m_uid of the result with the database and session it expects.
+    /// \throw dunedaq::confmodel::BadResolvedSession, if the input is not a valid resolved session of the supported format version,
+    /// or it was resolved with another schema version
+    ResolvedSession
+    read_resolved_session(std::istream& in);
+
+    /// write the resolved session to a file
+    void
+    write_resolved_session(const ResolvedSession& session, const std::string& file);
+
+    /// read the resolved session from a file
+    ResolvedSession
+    read_resolved_session(const std::string& file);
+
+} // namespace dunedaq::confmodel
+
+#endif // DUNEDAQDAL_RESOLVED_SESSION_H
@@ -0,0 +1,282 @@
+#ifndef DUNEDAQDAL_SESSION_INDEX_H
+#define DUNEDAQDAL_SESSION_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace dunedaq::conffwk {
+    class Configuration;
+}
+
+namespace dunedaq::confmodel {
+
+    class Session;
+
+    /**
+     *  \brief Read-only index of a session mapped from a file.
+     *
+     *  The index is written once by SessionIndex::write() and mapped by every process using the session,
+     *  so all processes on a host share the same physical pages and none parses the database or builds
+     *  the object graph. The file contains no pointers, only tables:
+     *  - items (segments, applications and resources) with dense IDs in depth-first order from the session's
+     *    segment, interned UIDs and class names, kind and enabled state;
+     *  - "contains" (resource sets), "segments" and "applications" (segments, controller first) relationships
+     *    in compressed sparse row form;
+     *  - the readout map: detector streams ordered by source ID and detector to DAQ connections with their senders.
+     *
+     *  The file is bound to the database it was built from: is_valid() compares the database spec and
+     *  the hash of the data files containing the indexed objects.
+     */
+
+    class SessionIndex
+    {
+
+    public:
+
+      static constexpr std::uint32_t format_version = 1;
+      static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+
+      enum Kind : std::uint8_t { segment, application, resource_set, resource };
+
+        // the stored records
+
+      struct Item
+      {
+        std::uint32_t m_uid;            // string IDs
+        std::uint32_t m_class;
+        std::uint8_t m_kind;
+        std::uint8_t m_enabled;
+        std::uint16_t m_reserved;
+      };
+
+      struct Stream
+      {
+        std::uint32_t m_item;
+        std::uint32_t m_source_id;
+        std::uint32_t m_detector_id;
+        std::uint32_t m_crate_id;
+        std::uint32_t m_slot_id;
+        std::uint32_t m_stream_id;
+      };
+
+      struct ReadoutConnection
+      {
+        std::uint32_t m_item;
+        std::uint32_t m_receiver;       // item ID of the receiver
+      };
+
+        // view of an array in the mapped file
+
+      template<class T>
+      class Range
+      {
+
+      public:
+
+        Range(const T * begin, const T * end) noexcept : m_begin(begin), m_end(end) { ; }
+
+        const T * begin() const noexcept { return m_begin; }
+        const T * end() const noexcept { return m_end; }
+        std::size_t size() const noexcept { return m_end - m_begin; }
+        bool empty() const noexcept { return m_begin == m_end; }
+        const T& operator[](std::size_t idx) const noexcept { return m_begin[idx]; }
+
+      private:
+
+        const T * m_begin;
+        const T * m_end;
+      };
+
+      /**
+       *  \brief Build the index of the session and write it to the file.
+       *
+       *  The file is replaced atomically, so processes having the previous version mapped are not affected.
+       *
+       *  \throw dunedaq::conffwk::Exception, dunedaq::confmodel::ConfigurationError or dunedaq::confmodel::BadSessionIndex
+       */
+
+      static void
+      write(dunedaq::conffwk::Configuration& db, const Session& session, const std::string& file);
+
+      /**
+       *  \brief Map the index file read-only.
+       *
+       *  \param file    the index file
+       *  \param verify  also check the hash of the whole contents; this reads every page of the file, so it is not
+       *                 used by default. The tables layout, their offsets and all stored IDs are always checked,
+       *                 so a truncated or corrupted file cannot make the accessors read outside the mapping;
+       *                 the strings are read on first access.
+       *
+       *  \throw dunedaq::confmodel::BadSessionIndex, if the file cannot be mapped or is not a valid index
+       */
+
+      explicit SessionIndex(const std::string& file, bool verify = false);
+
+      ~SessionIndex();
+
+      SessionIndex(const SessionIndex&) = delete;
+      SessionIndex& operator=(const SessionIndex&) = delete;
+
+      /// true, if the index was built from the database with given spec and its data files did not change since
+      bool
+      is_valid(const std::string& spec) const;
+
+      std::string_view
+      get_session() const
+      {
+        return get_string(header().m_session);
+      }
+
+      std::string_view
+      get_spec() const
+      {
+        return get_string(header().m_spec);
+      }
+
+      /// number of items; the item 0 is the session's segment; item IDs passed to the methods below must be less than size()
+      std::uint32_t
+      size() const noexcept
+      {
+        return get<Item>(items).size();
+      }
+
+      /// item ID by UID or npos
+      std::uint32_t
+      find(std::string_view uid) const;
+
+      std::string_view
+      get_uid(std::uint32_t id) const
+      {
+        return get_string(get<Item>(items)[id].m_uid);
+      }
+
+      std::string_view
+      get_class_name(std::uint32_t id) const
+      {
+        return get_string(get<Item>(items)[id].m_class);
+      }
+
+      Kind
+      get_kind(std::uint32_t id) const
+      {
+        return static_cast<Kind>(get<Item>(items)[id].m_kind);
+      }
+
+      bool
+      is_enabled(std::uint32_t id) const
+      {
+        return get<Item>(items)[id].m_enabled != 0;
+      }
+
+      Range<std::uint32_t>
+      get_contains(std::uint32_t id) const
+      {
+        return get_adjacent(contains_offsets, contains_targets, id);
+      }
+
+      Range<std::uint32_t>
+      get_segments(std::uint32_t id) const
+      {
+        return get_adjacent(segments_offsets, segments_targets, id);
+      }
+
+      Range<std::uint32_t>
+      get_applications(std::uint32_t id) const
+      {
+        return get_adjacent(applications_offsets, applications_targets, id);
+      }
+
+      /// detector streams ordered by source ID
+      Range<Stream>
+      get_streams() const
+      {
+        return get<Stream>(streams);
+      }
+
+      /// the stream with given source ID or nullptr
+      const Stream *
+      find_stream(std::uint32_t source_id) const;
+
+      Range<ReadoutConnection>
+      get_readout_connections() const
+      {
+        return get<ReadoutConnection>(readout_connections);
+      }
+
+      /// item IDs of senders of the readout connection with given index (less than get_readout_connections().size())
+      Range<std::uint32_t>
+      get_senders(std::uint32_t idx) const
+      {
+        return get_adjacent(senders_offsets, senders_targets, idx);
+      }
+
+    private:
+
+      enum Table {
+        string_offsets, string_data, items, sorted_items,
+        contains_offsets, contains_targets, segments_offsets, segments_targets,
+        applications_offsets, applications_targets,
+        streams, readout_connections, senders_offsets, senders_targets,
+        files, num_of_tables
+      };
+
+      struct Header
+      {
+        char m_magic[8];
+        std::uint32_t m_version;
+        std::uint32_t m_byte_order;
+        std::uint64_t m_size;           // size of the file
+        std::uint64_t m_content_hash;   // hash of the file after the header
+        std::uint64_t m_source_hash;    // hash of the data files
+        std::uint32_t m_spec;           // string IDs
+        std::uint32_t m_session;
+        struct {
+          std::uint64_t m_offset;
+          std::uint64_t m_count;
+        } m_tables[num_of_tables];
+      };
+
+      const Header&
+      header() const noexcept
+      {
+        return *static_cast<const Header *>(m_data);
+      }
+
+      template<class T>
+      Range<T>
+      get(Table t) const noexcept
+      {
+        const T * begin = reinterpret_cast<const T *>(static_cast<const char *>(m_data) + header().m_tables[t].m_offset);
+        return Range<T>(begin, begin + header().m_tables[t].m_count);
+      }
+
+      std::string_view
+      get_string(std::uint32_t id) const
+      {
+        const auto offsets = get<std::uint32_t>(string_offsets);
+        return std::string_view(get<char>(string_data).begin() + offsets[id], offsets[id + 1] - offsets[id]);
+      }
+
+      Range<std::uint32_t>
+      get_adjacent(Table offsets, Table targets, std::uint32_t id) const
+      {
+        const auto o = get<std::uint32_t>(offsets);
+        const std::uint32_t * t = get<std::uint32_t>(targets).begin();
+        return Range<std::uint32_t>(t + o[id], t + o[id + 1]);
+      }
+
+      void
+      check(bool verify) const;
+
+      void * m_data;
+      std::size_t m_size;
+
+      friend class SessionIndexBuilder;
+    };
+
+} // namespace dunedaq::confmodel
+
+#endif // DUNEDAQDAL_SESSION_INDEX_H
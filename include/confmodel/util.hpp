@@ -73,7 +73,7 @@ get_session(dunedaq::conffwk::Configuration &conf, const std::string &name,
             const std::vector<std::string> *rclasses = nullptr);
 
 template <typename T>
-void add_json_value(conffwk::ConfigObject &obj, std::string &name,
+void add_json_value(conffwk::ConfigObject &obj, const std::string &name,
                     bool multi_value, nlohmann::json &attributes) {
   if (!multi_value) {
     T value;
@@ -86,33 +86,37 @@ void add_json_value(conffwk::ConfigObject &obj, std::string &name,
   }
 }
 
-template <typename T>
-const std::vector<std::string> construct_commandline_parameters_appfwk(
-    const T *app, const conffwk::Configuration &confdb,
-    const dunedaq::confmodel::Session *session) {
-
-  const dunedaq::confmodel::Service *control_service = nullptr;
-
-  for (auto const *as : app->get_exposes_service())
-    if (as->UID() ==
-        app->UID() + "_control") // unclear this is the best way to do this.
-      control_service = as;
+/**
+ *  \brief Get the control service of an application.
+ *
+ *  \return Returns the service exposed by the application with UID
+ * "<application UID>_control", or nullptr if there is none.
+ */
 
-  if (control_service == nullptr)
-    throw NoControlServiceDefined(ERS_HERE, app->UID());
+const dunedaq::confmodel::Service *
+get_control_service(const dunedaq::confmodel::Application &app);
 
-  const std::string control_uri = control_service->get_protocol() + "://" +
-                                  app->get_runs_on()->get_runs_on()->UID() +
-                                  ":" +
-                                  std::to_string(control_service->get_port());
+/// the "protocol://host:port" URI of the control service on the physical host of the application
+std::string get_control_uri(const dunedaq::confmodel::Application &app,
+                            const dunedaq::confmodel::Service &control_service);
 
-  const std::string configuration_uri = confdb.get_impl_spec();
+/**
+ *  \brief Command line arguments of DAQ and run control applications.
+ *
+ *  These are the only definitions of the arguments, used by the
+ *  construct_commandline_parameters() methods and by LaunchPlan; S is
+ *  std::string or std::string_view.
+ */
 
+template <typename S>
+std::vector<S> make_daq_application_arguments(S session_id, S app_id,
+                                              S control_uri,
+                                              S configuration_uri) {
   return {
       "-s",
-      session->UID(),
+      session_id,
       "--name",
-      app->UID(),
+      app_id,
       "-c",
       control_uri,
       "--configurationService",
@@ -120,6 +124,30 @@ const std::vector<std::string> construct_commandline_parameters_appfwk(
   };
 }
 
+template <typename S>
+std::vector<S> make_rc_application_arguments(S log_level,
+                                             S configuration_uri,
+                                             S control_uri, S app_id,
+                                             S session_id) {
+  return {"-l", log_level, configuration_uri, control_uri, app_id, session_id};
+}
+
+template <typename T>
+const std::vector<std::string> construct_commandline_parameters_appfwk(
+    const T *app, const conffwk::Configuration &confdb,
+    const dunedaq::confmodel::Session *session) {
+
+  const dunedaq::confmodel::Service *control_service =
+      get_control_service(*app);
+
+  if (control_service == nullptr)
+    throw NoControlServiceDefined(ERS_HERE, app->UID());
+
+  return make_daq_application_arguments<std::string>(
+      session->UID(), app->UID(), get_control_uri(*app, *control_service),
+      confdb.get_impl_spec());
+}
+
 } // namespace confmodel
 
 ERS_DECLARE_ISSUE(confmodel, AlgorithmError, , )
@@ -221,11 +249,10 @@ ERS_DECLARE_ISSUE_BASE(confmodel, CannotGetParents, AlgorithmError,
 
 ERS_DECLARE_ISSUE_BASE(
     confmodel, FoundCircularDependency, AlgorithmError,
-    "Reach maximum allowed recursion ("
-        << limit << ") during calculation of " << goal
-        << "; possibly there is circular dependency between these objects: "
-        << objects,
-    , ((unsigned int)limit)((const char *)goal)((std::string)objects))
+    "Found circular dependency between " << size
+        << " objects during calculation of " << goal
+        << " (objects of each cycle are separated by semicolon): " << objects,
+    , ((unsigned int)size)((const char *)goal)((std::string)objects))
 
 ERS_DECLARE_ISSUE_BASE(
     confmodel, NoJarFile, AlgorithmError,
@@ -247,6 +274,16 @@ ERS_DECLARE_ISSUE_BASE(
                      << "\n  2) " << second,
     , ((std::string)segment)((std::string)first)((std::string)second))
 
+ERS_DECLARE_ISSUE_BASE(confmodel, BadResolvedSession, AlgorithmError,
+                       "Bad resolved session \'" << name
+                                                << "\': " << reason,
+                       , ((std::string)name)((std::string)reason))
+
+ERS_DECLARE_ISSUE_BASE(confmodel, BadSessionIndex, AlgorithmError,
+                       "Bad session index \'" << file
+                                             << "\': " << reason,
+                       , ((std::string)file)((std::string)reason))
+
 } // namespace dunedaq
 
 #endif
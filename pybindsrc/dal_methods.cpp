@@ -15,9 +15,13 @@
 #include "confmodel/HostComponent.hpp"
 #include "confmodel/RCApplication.hpp"
 #include "confmodel/Session.hpp"
+#include "confmodel/disabled-components.hpp"
+#include "confmodel/environment.hpp"
 
 
+#include <map>
 #include <sstream>
+#include <unordered_map>
 
 namespace py = pybind11;
 using namespace dunedaq::conffwk;
@@ -68,6 +72,88 @@ namespace dunedaq::confmodel::python {
     session->set_disabled(objs);
   }
 
+  void
+  session_disable_more(const Configuration& db,
+                       const std::string& session_name,
+                       const std::vector<std::string>& comps) {
+    auto session=const_cast<Configuration&>(db).get<Session>(session_name);
+    std::set<const Component*> objs;
+    for (auto comp: comps) {
+      auto obj=const_cast<Configuration&>(db).get<Component>(comp);
+      objs.insert(obj);
+    }
+    session->disable_more(objs);
+  }
+
+  void
+  session_enable_again(const Configuration& db,
+                       const std::string& session_name,
+                       const std::vector<std::string>& comps) {
+    auto session=const_cast<Configuration&>(db).get<Session>(session_name);
+    std::set<const Component*> objs;
+    for (auto comp: comps) {
+      auto obj=const_cast<Configuration&>(db).get<Component>(comp);
+      objs.insert(obj);
+    }
+    session->enable_again(objs);
+  }
+
+  std::shared_ptr<DisabledSnapshot>
+  session_get_disabled_snapshot(const Configuration& db,
+                                const std::string& session_name) {
+    auto session=const_cast<Configuration&>(db).get<Session>(session_name);
+    return std::const_pointer_cast<DisabledSnapshot>(session->get_disabled_snapshot());
+  }
+
+  std::uint64_t
+  session_get_disabled_generation(const Configuration& db,
+                                  const std::string& session_name) {
+    auto session=const_cast<Configuration&>(db).get<Session>(session_name);
+    return session->get_disabled_generation();
+  }
+
+  std::vector<std::pair<std::vector<ObjectLocator>, std::vector<ObjectLocator>>>
+  session_evaluate_disabled(const Configuration& db,
+                            const std::string& session_id,
+                            const std::vector<std::vector<std::string>>& candidates_ids) {
+    auto session = const_cast<Configuration&>(db).get<dunedaq::confmodel::Session>(session_id);
+    std::vector<std::set<const dunedaq::confmodel::Component*>> candidates;
+    for (const auto& ids : candidates_ids) {
+      std::set<const dunedaq::confmodel::Component*> objs;
+      for (const auto& id : ids) {
+        objs.insert(const_cast<Configuration&>(db).get<dunedaq::confmodel::Component>(id));
+      }
+      candidates.push_back(objs);
+    }
+
+    std::vector<std::pair<std::vector<ObjectLocator>, std::vector<ObjectLocator>>> results;
+    for (const auto& result : session->evaluate_disabled(candidates)) {
+      std::vector<ObjectLocator> apps;
+      for (const auto& app : result.m_enabled_applications) {
+        apps.push_back({app->UID(), app->class_name()});
+      }
+      std::vector<ObjectLocator> streams;
+      for (const auto& stream : result.m_enabled_streams) {
+        streams.push_back({stream->UID(), stream->class_name()});
+      }
+      results.emplace_back(apps, streams);
+    }
+    return results;
+  }
+
+  bool snapshot_disabled(const DisabledSnapshot& snapshot, const Configuration& db, const std::string& component_id) {
+    try {
+      ConfigObject object;
+      const_cast<Configuration&>(db).get("Component", component_id, object);
+    }
+    catch (conffwk::NotFound& except) {
+      return false;
+    }
+    const dunedaq::confmodel::Component* component_ptr = const_cast<Configuration&>(db).get<dunedaq::confmodel::Component>(component_id);
+
+    return snapshot.is_disabled(*component_ptr);
+  }
+
   bool component_disabled(const Configuration& db, const std::string& session_id, const std::string& component_id) {
     try {
       ConfigObject object;
@@ -82,6 +168,18 @@ namespace dunedaq::confmodel::python {
     return component_ptr->disabled(*session_ptr);
   }
 
+  std::vector<std::pair<ObjectLocator, std::string>> component_disabled_reason(const Configuration& db, const std::string& session_id, const std::string& component_id) {
+    const dunedaq::confmodel::Component* component_ptr = const_cast<Configuration&>(db).get<dunedaq::confmodel::Component>(component_id);
+    const dunedaq::confmodel::Session* session_ptr = const_cast<Configuration&>(db).get<dunedaq::confmodel::Session>(session_id);
+
+    std::vector<std::pair<ObjectLocator, std::string>> chain;
+    for (const auto& step : component_ptr->disabled_reason(*session_ptr)) {
+      chain.emplace_back(ObjectLocator(step.m_component->UID(), step.m_component->class_name()),
+                         DisabledReason::str(step.m_cause));
+    }
+    return chain;
+  }
+
 
   std::vector<std::vector<ObjectLocator>> component_get_parents(const Configuration& db,
                                                                 const std::string& session_id,
@@ -106,6 +204,40 @@ namespace dunedaq::confmodel::python {
     return parent_ids;
   }
 
+  std::map<std::string, std::vector<std::vector<ObjectLocator>>> session_get_all_parents(const Configuration& db,
+                                                                                        const std::string& session_id) {
+    const dunedaq::confmodel::Session* session_ptr = const_cast<Configuration&>(db).get<dunedaq::confmodel::Session>(session_id);
+
+    std::unordered_map<const dunedaq::confmodel::Component*, std::list<std::vector<const dunedaq::confmodel::Component*>>> parents;
+    std::map<std::string, std::vector<std::vector<ObjectLocator>>> parent_ids;
+
+    session_ptr->get_all_parents(parents);
+
+    for (const auto& component : parents) {
+      auto& paths = parent_ids[component.first->UID()];
+      for (const auto& parent : component.second) {
+        std::vector<ObjectLocator> parents_components;
+        for (const auto& ancestor_component_ptr : parent) {
+          parents_components.emplace_back(
+            ObjectLocator(ancestor_component_ptr->UID(),
+                          ancestor_component_ptr->class_name()) );
+        }
+        paths.emplace_back(parents_components);
+      }
+    }
+    return parent_ids;
+  }
+
+  std::map<std::string, std::map<std::string, std::string>> session_get_environments(const Configuration& db,
+                                                                                    const std::string& session_id) {
+    const auto* session = const_cast<Configuration&>(db).get<dunedaq::confmodel::Session>(session_id);
+    std::map<std::string, std::map<std::string, std::string>> environments;
+    for (const auto& x : EnvironmentResolver(*session).get_environments()) {
+      environments.emplace(x.first->UID(), *x.second);
+    }
+    return environments;
+  }
+
   std::vector<std::string> daq_application_get_used_hostresources(const Configuration& db, const std::string& app_id) {
     auto app = const_cast<Configuration&>(db).get<dunedaq::confmodel::DaqApplication>(app_id);
     std::vector<std::string> resources;
@@ -142,9 +274,24 @@ register_dal_methods(py::module& m)
   m.def("session_get_all_applications", &session_get_all_applications, "Get list of ALL applications (regardless of enabled/disabled state) in the requested session");
   m.def("session_get_enabled_applications", &session_get_enabled_applications, "Get list of enabled applications in the requested session");
   m.def("session_set_disabled", &session_set_disabled, "Temporarily disable Components in the requested session");
+  m.def("session_disable_more", &session_disable_more, "Temporarily disable more Components in the requested session, keeping those already disabled");
+  m.def("session_enable_again", &session_enable_again, "Revert temporary disabling of Components in the requested session");
+
+  py::class_<DisabledSnapshot, std::shared_ptr<DisabledSnapshot>>(m, "DisabledSnapshot")
+    .def_property_readonly("generation", &DisabledSnapshot::generation)
+    .def("size", &DisabledSnapshot::size, "Number of disabled components")
+    .def("disabled", &snapshot_disabled, "Determine if a Component-derived object was disabled when the snapshot was taken")
+    ;
+
+  m.def("session_get_disabled_snapshot", &session_get_disabled_snapshot, "Get immutable enabled/disabled state of the requested session");
+  m.def("session_get_disabled_generation", &session_get_disabled_generation, "Get generation of the enabled/disabled state of the requested session; it changes on any disable/enable or database change");
+  m.def("session_evaluate_disabled", &session_evaluate_disabled, "For each candidate list of Components to disable, get the enabled applications and detector streams without changing the session");
 
   m.def("component_disabled", &component_disabled, "Determine if a Component-derived object (e.g. a Segment) has been disabled");
+  m.def("component_disabled_reason", &component_disabled_reason, "Explain why a Component-derived object has been disabled: list of (object, reason) pairs ending with the explicitly disabled one");
   m.def("component_get_parents", &component_get_parents, "Get the Component-derived class instances of the parent(s) of the Component-derived object in question");
+  m.def("session_get_all_parents", &session_get_all_parents, "Get the parent(s) of every Component-derived object of the session, as a dictionary indexed by object id");
+  m.def("session_get_environments", &session_get_environments, "Get the process environment of every enabled application of the session, as a dictionary indexed by application id");
   m.def("daqapp_get_used_resources", &daq_application_get_used_hostresources, "Get list of HostResources used by DAQApplication");
   m.def("daq_application_construct_commandline_parameters", &daq_application_construct_commandline_parameters, "Get a version of the command line agruments parsed");
   m.def("rc_application_construct_commandline_parameters", &rc_application_construct_commandline_parameters, "Get a version of the command line agruments parsed");
@@ -0,0 +1,118 @@
+#include "confmodel/command-line.hpp"
+
+#include "confmodel/Application.hpp"
+#include "confmodel/Session.hpp"
+#include "confmodel/util.hpp"
+
+#include <cstdlib>
+#include <mutex>
+#include <unordered_map>
+
+using namespace dunedaq::confmodel;
+
+CommandLineTemplate::CommandLineTemplate(const std::string& text)
+{
+  std::string::size_type pos = 0;
+
+  while (pos < text.size()) {
+    const auto start = text.find("${", pos);
+
+    if (start == std::string::npos) {
+      break;
+    }
+
+    const auto end = text.find('}', start + 2);
+
+    if (end == std::string::npos || end == start + 2) {
+      throw BadVariableUsage(ERS_HERE, "bad variable reference in \"" + text + "\": expected ${NAME} at position " + std::to_string(start));
+    }
+
+    if (start > pos) {
+      m_segments.push_back({false, text.substr(pos, start - pos)});
+      m_size += start - pos;
+    }
+
+    m_segments.push_back({true, text.substr(start + 2, end - start - 2)});
+    m_has_variables = true;
+    pos = end + 1;
+  }
+
+  if (pos < text.size()) {
+    m_segments.push_back({false, text.substr(pos)});
+    m_size += text.size() - pos;
+  }
+}
+
+  // templates do not depend on the database, so they are shared by all expanders and Application methods;
+  // elements of unordered_map are never moved
+
+const CommandLineTemplate&
+CommandLineTemplate::get(const std::string& text)
+{
+  static std::mutex mutex;
+  static std::unordered_map<std::string, CommandLineTemplate> templates;
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  auto it = templates.find(text);
+
+  if (it == templates.end()) {
+    it = templates.emplace(text, CommandLineTemplate(text)).first;
+  }
+
+  return it->second;
+}
+
+
+CommandLineExpander::CommandLineExpander(const Session * session)
+{
+  if (session) {
+    m_environment = std::make_unique<EnvironmentResolver>(*session);
+    m_session_variables.emplace("DUNEDAQ_SESSION", session->UID());
+    m_session_variables.emplace("DUNEDAQ_PARTITION", session->UID());
+  }
+}
+
+
+std::vector<std::string>
+CommandLineExpander::expand(const Application& app)
+{
+  const auto& parameters = app.get_commandline_parameters();
+
+  std::vector<std::string> result;
+  result.reserve(parameters.size());
+
+  std::shared_ptr<const EnvironmentResolver::Environment> env;
+
+  // the environment is resolved only if a parameter uses variables
+  auto lookup = [&](const std::string& name) -> const std::string * {
+    if (m_environment) {
+      if (!env) {
+        env = m_environment->get_environment(app);
+      }
+
+      auto it = env->find(name);
+      if (it != env->end()) {
+        return &it->second;
+      }
+
+      it = m_session_variables.find(name);
+      if (it != m_session_variables.end()) {
+        return &it->second;
+      }
+    }
+
+    if (const char * value = std::getenv(name.c_str())) {
+      return &m_process_variables.insert_or_assign(name, value).first->second;
+    }
+
+    return nullptr;
+  };
+
+  for (const auto& p : parameters) {
+    const CommandLineTemplate& t = CommandLineTemplate::get(p);
+    result.push_back(t.has_variables() ? t.expand(lookup) : p);
+  }
+
+  return result;
+}
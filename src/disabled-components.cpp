@@ -1,4 +1,8 @@
 #include "confmodel/Application.hpp"
+#include "confmodel/DetDataSender.hpp"
+#include "confmodel/DetectorStream.hpp"
+#include "confmodel/DetectorToDaqConnection.hpp"
+#include "confmodel/Resource.hpp"
 #include "confmodel/ResourceSet.hpp"
 #include "confmodel/ResourceSetAND.hpp"
 #include "confmodel/ResourceSetOR.hpp"
@@ -7,9 +11,15 @@
 #include "confmodel/util.hpp"
 #include "confmodel/disabled-components.hpp"
 
+#include "conffwk/Change.hpp"
 #include "logging/Logging.hpp"
 
-#include "test_circular_dependency.hpp"
+#include <algorithm>
+#include <future>
+#include <iterator>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
 
 using namespace dunedaq::conffwk;
 using namespace dunedaq::confmodel;
@@ -19,7 +29,13 @@ DisabledComponents::DisabledComponents(Configuration& db,
   m_db(db),
   m_session(session),
   m_num_of_slr_enabled_resources(0),
-  m_num_of_slr_disabled_resources(0)
+  m_num_of_slr_disabled_resources(0),
+  m_graph_published(false),
+  m_computed(false),
+  m_num_of_disabled(0),
+  m_generation(0),
+  m_session_changed(false),
+  m_enabled_applications_generation(0)
 {
   TLOG_DEBUG(2) <<  "construct the object " << (void *)this  ;
   m_db.add_action(this);
@@ -31,17 +47,90 @@ DisabledComponents::~DisabledComponents()
   m_db.remove_action(this);
 }
 
+  // only changes of the session object and of segments/resource sets used by the session graph
+  // affect the disabled state; user disabled/enabled components survive, unless they were removed
+
 void
-DisabledComponents::notify(std::vector<ConfigurationChange *>& /*changes*/) noexcept
+DisabledComponents::notify(std::vector<ConfigurationChange *>& changes) noexcept
 {
-  TLOG_DEBUG(2) <<  "reset session components because of notification callback on object " << (void *)this ;
-  __clear();
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  try {
+    init_classes();
+
+    std::set<std::string> changed_containers;
+    std::set<std::string> removed_components;
+    bool session_changed(false);
+
+    for (const auto& c : changes) {
+      const std::string& class_name = c->get_class_name();
+      const auto& modified = c->get_modified_objs();
+      const auto& removed = c->get_removed_objs();
+
+      if (m_session_classes.find(class_name) != m_session_classes.end()) {
+        if (std::find(removed.begin(), removed.end(), m_session->UID()) != removed.end()) {
+          TLOG_DEBUG(2) <<  "reset session components because session " << m_session->UID() << " was removed on object " << (void *)this ;
+          __clear();
+          return;
+        }
+
+        if (std::find(modified.begin(), modified.end(), m_session->UID()) != modified.end()) {
+          session_changed = true;
+        }
+      }
+
+      if (m_container_classes.find(class_name) != m_container_classes.end()) {
+        changed_containers.insert(modified.begin(), modified.end());
+        changed_containers.insert(removed.begin(), removed.end());
+      }
+
+      if (m_component_classes.find(class_name) != m_component_classes.end()) {
+        removed_components.insert(removed.begin(), removed.end());
+      }
+    }
+
+    bool user_changed(false);
+
+    for (auto * objs : {&m_user_disabled, &m_user_enabled}) {
+      for (auto it = objs->begin(); it != objs->end();) {
+        if (removed_components.find((*it)->UID()) != removed_components.end()) {
+          it = objs->erase(it);
+          user_changed = true;
+        }
+        else {
+          ++it;
+        }
+      }
+    }
+
+    if (user_changed) {
+      m_num_of_slr_disabled_resources = m_user_disabled.size();
+      m_num_of_slr_enabled_resources = m_user_enabled.size();
+    }
+
+    if (user_changed || in_graph(changed_containers) || in_graph(removed_components)) {
+      TLOG_DEBUG(2) <<  "reset session graph because of notification callback on object " << (void *)this ;
+      drop_graph();
+    }
+    else if (session_changed) {
+      TLOG_DEBUG(2) <<  "check session disabled components because of notification callback on object " << (void *)this ;
+      mark_session_changed();
+    }
+    else {
+      TLOG_DEBUG(2) <<  "ignore notification callback not affecting session components on object " << (void *)this ;
+    }
+  }
+  catch (const std::exception& ex) {
+    TLOG_DEBUG(2) <<  "reset session components because notification cannot be processed on object " << (void *)this << ": " << ex.what() ;
+    __clear();
+  }
 }
 
 void
 DisabledComponents::load() noexcept
 {
   TLOG_DEBUG(2) <<  "reset session components because of configuration load on object " << (void *)this ;
+  std::lock_guard<std::mutex> lock(m_mutex);
   __clear();
 }
 
@@ -49,297 +138,1385 @@ void
 DisabledComponents::unload() noexcept
 {
   TLOG_DEBUG(2) <<  "reset session components because of configuration unload on object " << (void *)this ;
+  std::lock_guard<std::mutex> lock(m_mutex);
   __clear();
 }
 
 void
 DisabledComponents::update(const ConfigObject& obj, const std::string& name) noexcept
 {
-  TLOG_DEBUG(2) <<  "reset session components because of configuration update (obj = " << obj << ", name = \'" << name << "\') on object " << (void *)this ;
-  __clear();
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  try {
+    init_classes();
+
+    const std::string& class_name = obj.class_name();
+
+    if (m_session_classes.find(class_name) != m_session_classes.end() && obj.UID() == m_session->UID()) {
+      if (name == "segment" || name == "disabled") {
+        TLOG_DEBUG(2) <<  "check session disabled components because of configuration update (obj = " << obj << ", name = \'" << name << "\') on object " << (void *)this ;
+        mark_session_changed();
+        return;
+      }
+    }
+    else if (m_container_classes.find(class_name) != m_container_classes.end() && (name == "contains" || name == "segments" || name == "applications")) {
+      if (m_graph && m_graph->m_index.find(obj.implementation()) != m_graph->m_index.end()) {
+        TLOG_DEBUG(2) <<  "reset session graph because of configuration update (obj = " << obj << ", name = \'" << name << "\') on object " << (void *)this ;
+        drop_graph();
+        return;
+      }
+    }
+
+    TLOG_DEBUG(2) <<  "ignore configuration update (obj = " << obj << ", name = \'" << name << "\') not affecting session components on object " << (void *)this ;
+  }
+  catch (const std::exception& ex) {
+    TLOG_DEBUG(2) <<  "reset session components because configuration update cannot be processed on object " << (void *)this << ": " << ex.what() ;
+    __clear();
+  }
 }
 
 void
 DisabledComponents::reset() noexcept
 {
   TLOG_DEBUG(2) <<  "reset disabled by explicit user call" ;
-  m_disabled.clear(); // do not clear s_user_disabled && s_user_enabled !!!
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_generation++;
+  invalidate(); // do not clear s_user_disabled && s_user_enabled !!!
+}
+
+size_t
+DisabledComponents::size() noexcept
+{
+  auto snapshot = std::atomic_load(&m_snapshot);
+  return (snapshot ? snapshot->size() : 0);
+}
+
+  // drop calculated state; the next disabled() call recalculates it
+
+void
+DisabledComponents::invalidate() noexcept
+{
+  m_computed = false;
+  std::fill(m_disabled.begin(), m_disabled.end(), 0);
+  std::fill(m_closed.begin(), m_closed.end(), 0);
+  m_num_of_disabled = 0;
+  m_worklist.clear();
+
+  std::atomic_store(&m_snapshot, std::shared_ptr<const DisabledSnapshot>());
+}
+
+  // forget the session graph and the calculated state, e.g. on database changes
+
+void
+DisabledComponents::drop_graph() noexcept
+{
+  m_graph.reset();
+  m_graph_published = false;
+  m_session_changed = false;
+  m_session_seeds.clear();
+
+  m_generation++;
+  invalidate();
 }
 
+  // the published state is hidden; the session's disabled components are compared with
+  // ones used by the last calculation on next use and only the differences are recalculated
 
 void
-DisabledComponents::disable_children(const ResourceSet& rs)
+DisabledComponents::mark_session_changed() noexcept
+{
+  m_session_changed = true;
+  m_generation++;
+  std::atomic_store(&m_snapshot, std::shared_ptr<const DisabledSnapshot>());
+}
+
+void
+DisabledComponents::init_classes()
+{
+  if (!m_component_classes.empty()) {
+    return;
+  }
+
+  auto add = [this](std::set<std::string>& classes, const std::string& name) {
+    classes.insert(name);
+    for (const auto& c : m_db.get_class_info(name).p_subclasses) {
+      classes.insert(c);
+    }
+  };
+
+  add(m_session_classes, Session::s_class_name);
+  add(m_container_classes, Segment::s_class_name);
+  add(m_container_classes, ResourceSet::s_class_name);
+  add(m_component_classes, Component::s_class_name);
+}
+
+bool
+DisabledComponents::in_graph(const std::set<std::string>& uids) const
 {
-  for (auto & res : rs.get_contains()) {
-    disable(*res);
-    if (const auto * rs2 = res->cast<ResourceSet>()) {
-      disable_children(*rs2);
+  if (m_graph && !uids.empty()) {
+    for (const auto& node : m_graph->m_nodes) {
+      if (uids.find(node.m_obj->UID()) != uids.end()) {
+        return true;
+      }
     }
   }
+
+  return false;
 }
 
+  // make calculated state visible to readers; the graph is shared and becomes read-only
+
 void
-DisabledComponents::disable_children(const Segment& segment)
+DisabledComponents::publish()
+{
+  auto snapshot = std::make_shared<DisabledSnapshot>();
+  snapshot->m_graph = m_graph;
+  snapshot->m_disabled = m_disabled;
+  snapshot->m_closed = m_closed;
+  snapshot->m_reason = m_reason;
+  snapshot->m_cause = m_cause;
+  snapshot->m_num_of_disabled = m_num_of_disabled;
+  snapshot->m_generation = m_generation;
+
+  m_graph_published = true;
+
+  std::atomic_store(&m_snapshot, std::shared_ptr<const DisabledSnapshot>(std::move(snapshot)));
+}
+
+std::shared_ptr<const DisabledSnapshot>
+DisabledComponents::get_snapshot()
 {
-  for (auto & app : segment.get_applications()) {
-    auto res = app->cast<Component>();
-    if (res) {
-      disable(*res);
+  auto snapshot = std::atomic_load(&m_snapshot);
+
+  if (!snapshot) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // another thread may have calculated it while this one was waiting
+    snapshot = std::atomic_load(&m_snapshot);
+
+    if (!snapshot && m_session_changed) {
+      apply_session_changes();
+      snapshot = std::atomic_load(&m_snapshot);
+    }
+
+    if (!snapshot) {
+      if (m_session->get_disabled().empty() && m_user_disabled.empty()) {
+        TLOG_DEBUG( 6) << "Session has no disabled components";
+        auto empty = std::make_shared<DisabledSnapshot>();
+        empty->m_generation = m_generation;
+        snapshot = std::move(empty);
+        std::atomic_store(&m_snapshot, snapshot);
+      }
+      else {
+        // calculate explicitly and implicitly (nested) disabled components
+        compute();
+        snapshot = std::atomic_load(&m_snapshot);
+      }
     }
   }
-  for (auto & seg : segment.get_segments()) {
-    TLOG_DEBUG(6) <<  "disable segment " << seg << " because it's parent segment " << &segment << " is disabled" ;
-    disable(*seg);
-    disable_children(*seg);
+
+  return snapshot;
+}
+
+std::shared_ptr<const DisabledSnapshot>
+Session::get_disabled_snapshot() const
+{
+  return m_disabled_components.get_snapshot();
+}
+
+std::uint64_t
+Session::get_disabled_generation() const
+{
+  return m_disabled_components.m_generation;
+}
+
+std::vector<DisabledReason>
+DisabledSnapshot::get_reason(const Component& c) const
+{
+  std::vector<DisabledReason> chain;
+
+  if (m_graph) {
+    for (std::uint32_t id = m_graph->find(&c); id != DisabledComponents::Graph::npos && m_disabled[id]; id = m_cause[id]) {
+      chain.push_back({m_graph->m_nodes[id].m_obj, static_cast<DisabledReason::Cause>(m_reason[id])});
+    }
+
+    if (!chain.empty()) {
+      chain.front().m_component = &c;
+    }
   }
+
+  return chain;
+}
+
+bool
+DisabledSnapshot::is_stale(const Session& session) const
+{
+  return (m_generation != session.get_disabled_generation());
 }
 
 void
 Session::set_disabled(const std::set<const Component *>& objs) const
 {
-  m_disabled_components.m_user_disabled.clear();
+  std::lock_guard<std::mutex> lock(m_disabled_components.m_mutex);
 
-  for (const auto& comp : objs) {
-    m_disabled_components.m_user_disabled.insert(comp);
-  }
+  std::vector<const Component *> changed;
+  std::set_symmetric_difference(m_disabled_components.m_user_disabled.begin(), m_disabled_components.m_user_disabled.end(),
+                                objs.begin(), objs.end(), std::back_inserter(changed));
+
+  m_disabled_components.m_user_disabled = objs;
   m_disabled_components.m_num_of_slr_disabled_resources = m_disabled_components.m_user_disabled.size();
 
-  m_disabled_components.reset();
+  m_disabled_components.repropagate(changed);
 }
 
 void
 Session::set_enabled(const std::set<const Component *>& objs) const
 {
-  m_disabled_components.m_user_enabled.clear();
+  std::lock_guard<std::mutex> lock(m_disabled_components.m_mutex);
 
-  for (const auto& i : objs) {
-    m_disabled_components.m_user_enabled.insert(i);
-  }
+  std::vector<const Component *> changed;
+  std::set_symmetric_difference(m_disabled_components.m_user_enabled.begin(), m_disabled_components.m_user_enabled.end(),
+                                objs.begin(), objs.end(), std::back_inserter(changed));
+
+  m_disabled_components.m_user_enabled = objs;
   m_disabled_components.m_num_of_slr_enabled_resources = m_disabled_components.m_user_enabled.size();
 
-  m_disabled_components.reset();
+  m_disabled_components.repropagate(changed);
 }
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-namespace dunedaq {
-  ERS_DECLARE_ISSUE_BASE(
-    confmodel,
-    ReadMaxAllowedIterations,
-    AlgorithmError,
-    "Has exceeded the maximum of iterations allowed (" << limit << ") during calculation of disabled objects",
-    ,
-    ((unsigned int)limit)
-  )
+void
+Session::disable_more(const std::set<const Component *>& objs) const
+{
+  std::lock_guard<std::mutex> lock(m_disabled_components.m_mutex);
+
+  std::vector<const Component *> changed;
+
+  for (const auto& comp : objs) {
+    if (m_disabled_components.m_user_disabled.insert(comp).second) {
+      changed.push_back(comp);
+    }
+  }
+  m_disabled_components.m_num_of_slr_disabled_resources = m_disabled_components.m_user_disabled.size();
+
+  m_disabled_components.repropagate(changed);
+}
+
+void
+Session::enable_again(const std::set<const Component *>& objs) const
+{
+  std::lock_guard<std::mutex> lock(m_disabled_components.m_mutex);
+
+  std::vector<const Component *> changed;
+
+  for (const auto& comp : objs) {
+    if (m_disabled_components.m_user_disabled.erase(comp)) {
+      changed.push_back(comp);
+    }
+  }
+  m_disabled_components.m_num_of_slr_disabled_resources = m_disabled_components.m_user_disabled.size();
+
+  m_disabled_components.repropagate(changed);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  // fill data from resource sets
+  // copy the graph before modification, if it is used by a published snapshot
 
-static void fill(
-  const ResourceSet& rs,
-  std::vector<const ResourceSetOR *>& rs_or,
-  std::vector<const ResourceSetAND *>& rs_and,
-  TestCircularDependency& cd_fuse
-)
+DisabledComponents::Graph&
+DisabledComponents::mutable_graph()
 {
-  if (const ResourceSetAND * r1 = rs.cast<ResourceSetAND>())
-    {
-      rs_and.push_back(r1);
-    }
-  else if (const ResourceSetOR * r2 = rs.cast<ResourceSetOR>())
-    {
-      rs_or.push_back(r2);
+  if (m_graph_published) {
+    m_graph = std::make_shared<Graph>(*m_graph);
+    m_graph_published = false;
+  }
+
+  return *m_graph;
+}
+
+  // get dense index of the component; nodes are created on first access
+
+std::uint32_t
+DisabledComponents::get_node(const Component& c)
+{
+  std::uint32_t id = m_graph->find(&c);
+
+  if (id == Graph::npos) {
+    Graph& graph = mutable_graph();
+
+    static const std::pair<const std::string *, Node::Type> types[] = {
+      {&Segment::s_class_name, Node::is_segment},
+      {&Application::s_class_name, Node::is_application},
+      {&Resource::s_class_name, Node::is_resource},
+      {&ResourceSet::s_class_name, Node::is_resource_set},
+      {&ResourceSetAND::s_class_name, Node::is_resource_set_and},
+      {&ResourceSetOR::s_class_name, Node::is_resource_set_or},
+      {&DetDataSender::s_class_name, Node::is_det_data_sender},
+      {&DetectorStream::s_class_name, Node::is_detector_stream},
+      {&DetectorToDaqConnection::s_class_name, Node::is_d2d_connection}
+    };
+
+    std::uint16_t type(0);
+    for (const auto& t : types) {
+      if (c.castable(*t.first)) {
+        type |= t.second;
+      }
     }
 
-  for (auto & i : rs.get_contains())
-    {
-      AddTestOnCircularDependency add_fuse_test(cd_fuse, i);
-      if (const ResourceSet * rs2 = i->cast<ResourceSet>())
-        {
-          fill(*rs2, rs_or, rs_and, cd_fuse);
-        }
+    Node::Kind kind(Node::other);
+    if (type & Node::is_resource_set) {
+      kind = Node::resource_set;
     }
-}
+    else if (type & Node::is_segment) {
+      kind = Node::segment;
+    }
+
+    id = static_cast<std::uint32_t>(graph.m_nodes.size());
+    graph.m_index.emplace(c.config_object().implementation(), id);
+    graph.m_nodes.push_back({&c, kind, type, false, -1, {}, {}, {}, {}});
+
+    m_disabled.push_back(0);
+    m_closed.push_back(0);
+    m_reason.push_back(DisabledReason::enabled);
+    m_cause.push_back(Graph::npos);
+    m_mark.push_back(0);
+  }
 
+  return id;
+}
 
-  // fill data from segments
+  // register children of the component as seen by the disabled state algorithm
 
-static void fill(
-  const Segment& s,
-  std::vector<const ResourceSetOR *>& rs_or,
-  std::vector<const ResourceSetAND *>& rs_and,
-  TestCircularDependency& cd_fuse
-)
+void
+DisabledComponents::expand(std::uint32_t id)
 {
-  for (auto & app : s.get_applications()) {
-    AddTestOnCircularDependency add_fuse_test(cd_fuse, app);
-    if (const ResourceSet * rs = app->cast<ResourceSet>()) {
-      fill(*rs, rs_or, rs_and, cd_fuse);
+  if (m_graph->m_nodes[id].m_expanded) {
+    return;
+  }
+
+  const Node::Kind kind = m_graph->m_nodes[id].m_kind;
+  const Component * obj = m_graph->m_nodes[id].m_obj;
+
+  std::vector<std::uint32_t> children;
+  std::vector<std::pair<const Application *, std::uint32_t>> apps;
+
+  if (kind == Node::resource_set) {
+    for (auto & res : obj->cast<ResourceSet>()->get_contains()) {
+      children.push_back(get_node(*res));
+    }
+  }
+  else if (kind == Node::segment) {
+    const Segment * seg = obj->cast<Segment>();
+    for (auto & app : seg->get_applications()) {
+      if (auto res = app->cast<Component>()) {
+        children.push_back(get_node(*res));
+        apps.emplace_back(app, children.back());
+      }
+      else {
+        apps.emplace_back(app, Graph::npos);
+      }
+    }
+    for (auto & s : seg->get_segments()) {
+      children.push_back(get_node(*s));
     }
   }
 
-  for (auto & seg : s.get_segments()) {
-    TLOG_DEBUG(6) << "Filling segment " << seg->UID();
-    AddTestOnCircularDependency add_fuse_test(cd_fuse, seg);
-    fill(*seg, rs_or, rs_and, cd_fuse);
+  Graph& graph = mutable_graph();
+
+  for (auto child : children) {
+    graph.m_nodes[child].m_parents.push_back(id);
   }
-}
 
+  graph.m_nodes[id].m_children = std::move(children);
+  graph.m_nodes[id].m_applications = std::move(apps);
+  graph.m_nodes[id].m_expanded = true;
+}
 
-  // fill data from session
+  // register the component and all its descendants (parents are needed for incremental updates);
+  // the component may be not reachable from the session's segment, e.g. a disabled resource
 
-static void fill(
-  const Session& session,
-  std::vector<const ResourceSetOR *>& rs_or,
-  std::vector<const ResourceSetAND *>& rs_and,
-  TestCircularDependency& cd_fuse
-)
+void
+DisabledComponents::add_to_graph(std::uint32_t id)
 {
-#if 0
-  if (const OnlineSegment * onlseg = p.get_OnlineInfrastructure())
-    {
-      AddTestOnCircularDependency add_fuse_test(cd_fuse, onlseg);
-      fill(*onlseg, rs_or, rs_and, cd_fuse);
+  std::vector<std::uint32_t> stack{id};
 
-      // NOTE: normally application may not be ResourceSet, but for some "exotic" cases put this code
-      for (auto &a : p.get_OnlineInfrastructureApplications())
-        {
-          if (const ResourceSet * rs = a->cast<ResourceSet>())
-            {
-              fill(*rs, rs_or, rs_and, cd_fuse);
-            }
-        }
-    }
-#endif
+  while (!stack.empty()) {
+    const std::uint32_t n = stack.back();
+    stack.pop_back();
 
-  auto seg = session.get_segment();
-  AddTestOnCircularDependency add_fuse_test(cd_fuse, seg);
-  fill(*seg, rs_or, rs_and, cd_fuse);
+    if (!m_graph->m_nodes[n].m_expanded) {
+      expand(n);
+      const auto& children = m_graph->m_nodes[n].m_children;
+      stack.insert(stack.end(), children.begin(), children.end());
+    }
+  }
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  // the same set may be reached via several paths; register its "contained-by" edges once
 
-bool
-Component::disabled(const Session& session) const
+void
+DisabledComponents::add_set(std::uint32_t id, bool is_and)
 {
-  TLOG_DEBUG( 6) << "Session UID: " << session.UID() << " this->UID()=" << UID();
-  // fill disabled (e.g. after session changes)
+  if (m_graph->m_nodes[id].m_set < 0) {
+    expand(id);
+
+    Graph& graph = mutable_graph();
 
-  if (session.m_disabled_components.size() == 0) {
-    if (session.get_disabled().empty() && 
-        session.m_disabled_components.m_user_disabled.empty()) {
-      TLOG_DEBUG( 6) << "Session has no disabled components";
-      return false;  // the session has no disabled components
+    const std::int32_t idx = static_cast<std::int32_t>(graph.m_sets.size());
+    graph.m_nodes[id].m_set = idx;
+    graph.m_sets.push_back({id, is_and});
+
+    for (auto child : graph.m_nodes[id].m_children) {
+      graph.m_nodes[child].m_contained_by.push_back(idx);
     }
-    else {
-      // get two lists of all session's resource-set-or and resource-set-and
-      // also test any circular dependencies between segments and resource sets
-      TestCircularDependency cd_fuse("component \'is-disabled\' status", &session);
-      std::vector<const ResourceSetOR *> rs_or;
-      std::vector<const ResourceSetAND *> rs_and;
-      fill(session, rs_or, rs_and, cd_fuse);
-
-      // calculate explicitly and implicitly (nested) disabled components
-      {
-        std::vector<const Component *> vector_of_disabled;
-        vector_of_disabled.reserve(session.get_disabled().size() + session.m_disabled_components.m_user_disabled.size());
-
-        // add user disabled components, if any
-        for (auto & i : session.m_disabled_components.m_user_disabled) {
-          vector_of_disabled.push_back(i);
-          TLOG_DEBUG(6) <<  "disable component " << i->UID() << " because it is explicitly disabled by user" ;
-        }
+  }
+}
 
-        // add session-disabled components ignoring explicitly enabled by user
-        for (auto & i : session.get_disabled()) {
-          TLOG_DEBUG(6) <<  "check component " << i->UID() << " explicitly disabled in session" ;
+  // resource-set-OR/AND reachable from the session's segment; the strongly connected components
+  // of the followed edges are calculated at the same time (Tarjan's algorithm), so any circular
+  // dependency between segments or resource sets is reported with all its members; once the graph
+  // passed this test, the algorithms following the same edges may not test cycles
 
-          if (session.m_disabled_components.m_user_enabled.find(i) == session.m_disabled_components.m_user_enabled.end()) {
-            vector_of_disabled.push_back(i);
-            TLOG_DEBUG(6) <<  "disable component " << i->UID() << " because it is not explicitly enabled in session" ;
-          }
-          else {
-            TLOG_DEBUG(6) <<  "skip component " << i->UID() << " because it is enabled by user" ;
-          }
-        }
+std::vector<std::uint32_t>
+DisabledComponents::find_sets() const
+{
+  const Graph& graph = *m_graph;
 
-        // fill set of explicitly and implicitly (segment/resource-set containers) disabled components
-        for (auto & i : vector_of_disabled) {
-          session.m_disabled_components.disable(*i);
+  std::vector<std::uint32_t> sets;
+  std::vector<std::uint32_t> index(graph.m_nodes.size(), Graph::npos);
+  std::vector<std::uint32_t> low(graph.m_nodes.size(), 0);
+  std::vector<std::uint8_t> on_stack(graph.m_nodes.size(), 0);
+  std::vector<std::uint32_t> stack;
+  std::vector<std::pair<std::uint32_t, std::size_t>> path{{0, 0}};
+  std::vector<std::vector<std::uint32_t>> cycles;
+  std::uint32_t count(0);
 
-          if (const ResourceSet * rs = i->cast<ResourceSet>()) {
-            session.m_disabled_components.disable_children(*rs);
-          }
-          else if (const Segment * seg = i->cast<Segment>()) {
-            TLOG_DEBUG(6) << "Disabling children of segment " << seg->UID();
-            session.m_disabled_components.disable_children(*seg);
-          }
-        }
+  index[0] = low[0] = count++;
+  stack.push_back(0);
+  on_stack[0] = 1;
+
+  while (!path.empty()) {
+    const std::uint32_t id = path.back().first;
+    const Node& node = graph.m_nodes[id];
+
+    if (path.back().second == node.m_children.size()) {
+      path.pop_back();
+
+      if (!path.empty()) {
+        low[path.back().first] = std::min(low[path.back().first], low[id]);
       }
 
-      for (unsigned long count = 1; true; ++count) {
-        const unsigned long num(session.m_disabled_components.size());
-
-        TLOG_DEBUG(6) <<  "before auto-disabling iteration " << count << " the number of disabled components is " << num ;
-
-        TLOG_DEBUG(6) <<  "Session has " << rs_or.size() << " resourceSetORs";
-        for (const auto& i : rs_or) {
-          if (session.m_disabled_components.is_enabled(i)) {
-            // check ANY child is disabled
-            TLOG_DEBUG(6) << "ResourceSetOR " << i->UID() << " contains " << i->get_contains().size() << " resources";
-            for (auto & i2 : i->get_contains()) {
-              if (!session.m_disabled_components.is_enabled(i2)) {
-                TLOG_DEBUG(6) <<  "disable resource-set-OR " << i->UID() << " because it's child " << i2 << " is disabled" ;
-                session.m_disabled_components.disable(*i);
-                session.m_disabled_components.disable_children(*i);
-                break;
-              }
-            }
-          }
-        }
+      if (low[id] == index[id]) {
+        std::vector<std::uint32_t> scc;
+        std::uint32_t x;
+        do {
+          x = stack.back();
+          stack.pop_back();
+          on_stack[x] = 0;
+          scc.push_back(x);
+        } while (x != id);
 
-        TLOG_DEBUG(6) <<  "Session has " << rs_and.size() << " resourceSetANDs";
-        for (const auto& j : rs_and) {
-          if (session.m_disabled_components.is_enabled(j)) {
-            const std::vector<const ResourceBase*> &resources = j->get_contains();
-            TLOG_DEBUG(6) << "Checking " << resources.size() << " ResourceSetAND resources";
-            if (!resources.empty()) {
-              // check ANY child is enabled
-              bool found_enabled = false;
-              for (auto & j2 : resources) {
-                if (session.m_disabled_components.is_enabled(j2)) {
-                  found_enabled = true;
-                  TLOG_DEBUG(6) << "Found enabled resource " << j2->UID();
-                  break;
-                }
-              }
-              if (found_enabled == false) {
-                TLOG_DEBUG(6) <<  "disable resource-set-AND " << j->UID() << " because all it's children are disabled" ;
-                session.m_disabled_components.disable(*j);
-                session.m_disabled_components.disable_children(*j);
-              }
-            }
-          }
+        if (scc.size() > 1 || std::find(node.m_children.begin(), node.m_children.end(), id) != node.m_children.end()) {
+          std::reverse(scc.begin(), scc.end());
+          cycles.push_back(std::move(scc));
         }
+      }
 
-        if (session.m_disabled_components.size() == num) {
-          TLOG_DEBUG(6) <<  "after " << count << " iteration(s) auto-disabling algorithm found no newly disabled sets, exiting loop ..." ;
-          break;
-        }
+      continue;
+    }
 
-        unsigned int iLimit(1000);
-        if (count > iLimit) {
-          ers::error(ReadMaxAllowedIterations(ERS_HERE, iLimit));
-          break;
-        }
+    const std::uint32_t child = node.m_children[path.back().second++];
+    const Node& c = graph.m_nodes[child];
+
+    if (!Node::is_followed(node.m_kind, c.m_kind)) {
+      continue;
+    }
+
+    if (index[child] == Graph::npos) {
+      index[child] = low[child] = count++;
+      stack.push_back(child);
+      on_stack[child] = 1;
+      if (c.m_type & (Node::is_resource_set_and | Node::is_resource_set_or)) {
+        sets.push_back(child);
       }
+      path.emplace_back(child, 0);
+    }
+    else if (on_stack[child]) {
+      low[id] = std::min(low[id], index[child]);
     }
   }
 
-  bool result(!session.m_disabled_components.is_enabled(this));
-  TLOG_DEBUG( 6) <<  "disabled(" << this << ")  (UID=" << UID() << ") returns " << std::boolalpha << result  ;
-  return result;
+  if (!cycles.empty()) {
+    std::ostringstream s;
+    std::size_t num(0);
+    for (const auto& scc : cycles) {
+      if (num) {
+        s << "; ";
+      }
+      for (std::size_t i = 0; i < scc.size(); ++i) {
+        s << (i ? ", " : "") << graph.m_nodes[scc[i]].m_obj;
+      }
+      num += scc.size();
+    }
+    throw FoundCircularDependency(ERS_HERE, num, "session graph of segments and resource sets", s.str());
+  }
+
+  return sets;
+}
+
+void
+DisabledComponents::build_graph()
+{
+  m_graph = std::make_shared<Graph>();
+  m_graph_published = false;
+  m_disabled.clear();
+  m_closed.clear();
+  m_reason.clear();
+  m_cause.clear();
+  m_mark.clear();
+
+  try {
+    // index every component of the session
+    add_to_graph(get_node(*m_session->get_segment()));
+
+    for (auto id : find_sets()) {
+      add_set(id, (m_graph->m_nodes[id].m_type & Node::is_resource_set_and) != 0);
+    }
+  }
+  catch (...) {
+    m_graph.reset();
+    throw;
+  }
+
+  m_num_of_enabled.assign(m_graph->m_sets.size(), 0);
+
+  auto apps = std::make_shared<std::vector<const Application *>>();
+  auto add = [&apps](const Application * app) { apps->push_back(app); return true; };
+  visit_applications(*m_graph, 0, [](std::uint32_t) { return false; }, add);
+  m_graph->m_applications = std::move(apps);
+
+  TLOG_DEBUG(6) <<  "session graph has " << m_graph->m_nodes.size() << " components and " << m_graph->m_sets.size() << " resource sets OR/AND" ;
+}
+
+  // explicitly disabled components: by user and in the session ignoring explicitly enabled by user
+
+std::vector<DisabledComponents::Seed>
+DisabledComponents::get_seeds()
+{
+  std::vector<Seed> seeds;
+  seeds.reserve(m_session->get_disabled().size() + m_user_disabled.size());
+
+  // add user disabled components, if any
+  for (auto & i : m_user_disabled) {
+    TLOG_DEBUG(6) <<  "disable component " << i->UID() << " because it is explicitly disabled by user" ;
+    seeds.push_back({get_node(*i), DisabledReason::user_disabled});
+  }
+
+  // add session-disabled components ignoring explicitly enabled by user
+  for (auto & i : m_session->get_disabled()) {
+    TLOG_DEBUG(6) <<  "check component " << i->UID() << " explicitly disabled in session" ;
+
+    if (m_user_enabled.find(i) == m_user_enabled.end()) {
+      seeds.push_back({get_node(*i), DisabledReason::session_disabled});
+      TLOG_DEBUG(6) <<  "disable component " << i->UID() << " because it is not explicitly enabled in session" ;
+    }
+    else {
+      TLOG_DEBUG(6) <<  "skip component " << i->UID() << " because it is enabled by user" ;
+    }
+  }
+
+  for (const auto& s : seeds) {
+    add_to_graph(s.m_node);
+  }
+
+  return seeds;
+}
+
+  // sorted nodes of the components disabled in the session database object
+
+std::vector<std::uint32_t>
+DisabledComponents::get_session_seeds()
+{
+  std::vector<std::uint32_t> seeds;
+  seeds.reserve(m_session->get_disabled().size());
+
+  for (auto & i : m_session->get_disabled()) {
+    seeds.push_back(get_node(*i));
+  }
+
+  std::sort(seeds.begin(), seeds.end());
+  seeds.erase(std::unique(seeds.begin(), seeds.end()), seeds.end());
+
+  return seeds;
+}
+
+  // the session object was modified: rebuild everything if its segment was changed,
+  // otherwise recalculate components which session disabled status was changed
+
+void
+DisabledComponents::apply_session_changes()
+{
+  m_session_changed = false;
+
+  if (m_graph && m_graph->m_nodes.front().m_obj->config_object().implementation() != m_session->get_segment()->config_object().implementation()) {
+    TLOG_DEBUG(6) <<  "segment of session " << m_session->UID() << " was changed" ;
+    m_graph.reset();
+    m_graph_published = false;
+    invalidate();
+    return;
+  }
+
+  if (!m_computed) {
+    return;
+  }
+
+  auto seeds(get_session_seeds());
+
+  std::vector<std::uint32_t> diff;
+  std::set_symmetric_difference(m_session_seeds.begin(), m_session_seeds.end(), seeds.begin(), seeds.end(), std::back_inserter(diff));
+
+  m_session_seeds = std::move(seeds);
+
+  TLOG_DEBUG(6) <<  "disabled status of " << diff.size() << " components was changed in session " << m_session->UID() ;
+
+  if (diff.empty()) {
+    publish();
+    return;
+  }
+
+  std::vector<const Component *> changed;
+  changed.reserve(diff.size());
+  for (auto id : diff) {
+    changed.push_back(m_graph->m_nodes[id].m_obj);
+  }
+
+  repropagate(changed);
+}
+
+  // disable children of a segment or resource set; nested segments of a segment and nested
+  // resource sets of a resource set disable their children too
+
+void
+DisabledComponents::disable_children(std::uint32_t id)
+{
+  if (m_closed[id]) {
+    return;
+  }
+
+  m_closed[id] = 1;
+
+  const Node& node = m_graph->m_nodes[id];
+  const DisabledReason::Cause reason(node.m_kind == Node::segment ? DisabledReason::parent_segment : DisabledReason::parent_resource_set);
+  for (auto child : node.m_children) {
+    disable(child, reason, id);
+    if (m_graph->m_nodes[child].m_kind == node.m_kind) {
+      if (node.m_kind == Node::segment) {
+        TLOG_DEBUG(6) <<  "disable segment " << m_graph->m_nodes[child].m_obj << " because it's parent segment " << node.m_obj << " is disabled" ;
+      }
+      disable_children(child);
+    }
+  }
+}
+
+  // disable explicitly disabled component and its segment/resource-set children
+
+void
+DisabledComponents::seed(const Seed& s)
+{
+  const std::uint32_t id(s.m_node);
+
+  // explicit disabling is preferred explanation, even if the component was reached by propagation before
+  if (m_disabled[id] && m_cause[id] != Graph::npos) {
+    m_reason[id] = s.m_cause;
+    m_cause[id] = Graph::npos;
+  }
+
+  disable(id, s.m_cause, Graph::npos);
+
+  if (m_graph->m_nodes[id].m_kind != Node::other) {
+    TLOG_DEBUG(6) << "Disabling children of " << m_graph->m_nodes[id].m_obj->UID();
+    disable_children(id);
+  }
+}
+
+  // propagate disabled state from resources to the OR/AND resource sets containing them;
+  // every disabled component is dequeued once and visits only its own "contained-by" edges,
+  // so the cost is linear in the number of resource sets and their relationships
+
+void
+DisabledComponents::propagate()
+{
+  const Graph& graph = *m_graph;
+
+  TLOG_DEBUG(6) <<  "propagate " << m_worklist.size() << " disabled components through " << graph.m_sets.size() << " resource sets" ;
+
+  while (!m_worklist.empty()) {
+    const std::uint32_t id = m_worklist.back();
+    m_worklist.pop_back();
+
+    for (auto idx : graph.m_nodes[id].m_contained_by) {
+      const SetInfo& s = graph.m_sets[idx];
+      if (s.m_is_and) {
+        if (--m_num_of_enabled[idx] == 0 && m_disabled[s.m_node] == 0) {
+          TLOG_DEBUG(6) <<  "disable resource-set-AND " << graph.m_nodes[s.m_node].m_obj->UID() << " because all it's children are disabled" ;
+          disable(s.m_node, DisabledReason::and_children, id);
+          disable_children(s.m_node);
+        }
+      }
+      else if (m_disabled[s.m_node] == 0) {
+        TLOG_DEBUG(6) <<  "disable resource-set-OR " << graph.m_nodes[s.m_node].m_obj->UID() << " because it's child " << graph.m_nodes[id].m_obj->UID() << " is disabled" ;
+        disable(s.m_node, DisabledReason::or_child, id);
+        disable_children(s.m_node);
+      }
+    }
+  }
+}
+
+void
+DisabledComponents::compute()
+{
+  if (!m_graph) {
+    build_graph();
+  }
+
+  const auto seeds(get_seeds());
+  m_session_seeds = get_session_seeds();
+  m_session_changed = false;
+
+  std::fill(m_disabled.begin(), m_disabled.end(), 0);
+  std::fill(m_closed.begin(), m_closed.end(), 0);
+  m_num_of_disabled = 0;
+  m_worklist.clear();
+
+  for (std::size_t idx = 0; idx < m_graph->m_sets.size(); ++idx) {
+    m_num_of_enabled[idx] = m_graph->m_nodes[m_graph->m_sets[idx].m_node].m_children.size();
+  }
+
+  // fill set of explicitly and implicitly (segment/resource-set containers) disabled components
+  for (const auto& s : seeds) {
+    seed(s);
+  }
+
+  // all explicitly and implicitly disabled components are queued by now
+  propagate();
+
+  m_computed = true;
+  publish();
+}
+
+void
+DisabledComponents::repropagate(const std::vector<const Component *>& changed)
+{
+  if (changed.empty()) {
+    return;
+  }
+
+  m_generation++;
+
+  if (m_session_changed) {
+    apply_session_changes();
+  }
+
+  if (!m_computed) {
+    // nothing is calculated yet, the next disabled() call will do it from scratch
+    invalidate();
+    return;
+  }
+
+  // the affected region: descendants of changed components and, transitively,
+  // resource-set-OR/AND containing any of them together with their descendants;
+  // the state of any component outside the region does not depend on the changed ones
+
+  std::vector<std::uint32_t> stack;
+  for (auto & c : changed) {
+    stack.push_back(get_node(*c));
+    add_to_graph(stack.back());
+  }
+
+  const auto seeds(get_seeds());
+
+  const Graph& graph = *m_graph;
+
+  std::vector<std::uint32_t> region;
+
+  while (!stack.empty()) {
+    const std::uint32_t id = stack.back();
+    stack.pop_back();
+
+    if (m_mark[id]) {
+      continue;
+    }
+
+    m_mark[id] = 1;
+    region.push_back(id);
+
+    const Node& node = graph.m_nodes[id];
+    stack.insert(stack.end(), node.m_children.begin(), node.m_children.end());
+    for (auto idx : node.m_contained_by) {
+      stack.push_back(graph.m_sets[idx].m_node);
+    }
+  }
+
+  TLOG_DEBUG(6) <<  "recalculate disabled state of " << region.size() << " components affected by " << changed.size() << " changed components" ;
+
+  m_worklist.clear();
+
+  for (auto id : region) {
+    if (m_disabled[id]) {
+      m_disabled[id] = 0;
+      m_num_of_disabled--;
+    }
+    m_closed[id] = 0;
+
+    if (graph.m_nodes[id].m_set >= 0) {
+      m_num_of_enabled[graph.m_nodes[id].m_set] = graph.m_nodes[id].m_children.size();
+    }
+  }
+
+  for (const auto& s : seeds) {
+    if (m_mark[s.m_node]) {
+      seed(s);
+    }
+  }
+
+  // disabled containers outside the region still disable their children in the region
+  for (auto id : region) {
+    for (auto p : graph.m_nodes[id].m_parents) {
+      if (m_mark[p] == 0 && m_closed[p]) {
+        TLOG_DEBUG(6) <<  "disable component " << graph.m_nodes[id].m_obj->UID() << " because it's parent " << graph.m_nodes[p].m_obj->UID() << " is disabled" ;
+        disable(id, (graph.m_nodes[p].m_kind == Node::segment ? DisabledReason::parent_segment : DisabledReason::parent_resource_set), p);
+        if (graph.m_nodes[id].m_kind == graph.m_nodes[p].m_kind) {
+          disable_children(id);
+        }
+      }
+    }
+  }
+
+  propagate();
+
+  for (auto id : region) {
+    m_mark[id] = 0;
+  }
+
+  publish();
+}
+
+  // the overlay only keeps components disabled in addition to the base snapshot, which is shared
+  // by all candidates; since more seeds can only disable more components, propagating them from
+  // the base state gives the same result as the calculation from scratch
+
+class DisabledComponents::Overlay
+{
+
+public:
+
+  explicit
+  Overlay(const DisabledSnapshot& base) :
+    m_base(base),
+    m_graph(*base.m_graph)
+  {
+  }
+
+  bool
+  is_disabled(std::uint32_t id) const
+  {
+    return (m_base.m_disabled[id] != 0 || m_disabled.find(id) != m_disabled.end());
+  }
+
+  void
+  seed(std::uint32_t id)
+  {
+    disable(id);
+
+    if (m_graph.m_nodes[id].m_kind != Node::other) {
+      disable_children(id);
+    }
+  }
+
+  void
+  propagate()
+  {
+    while (!m_worklist.empty()) {
+      const std::uint32_t id = m_worklist.back();
+      m_worklist.pop_back();
+
+      for (auto idx : m_graph.m_nodes[id].m_contained_by) {
+        const SetInfo& s = m_graph.m_sets[idx];
+        if (s.m_is_and) {
+          if (--num_of_enabled(idx) == 0 && !is_disabled(s.m_node)) {
+            disable(s.m_node);
+            disable_children(s.m_node);
+          }
+        }
+        else if (!is_disabled(s.m_node)) {
+          disable(s.m_node);
+          disable_children(s.m_node);
+        }
+      }
+    }
+  }
+
+private:
+
+  void
+  disable(std::uint32_t id)
+  {
+    if (!is_disabled(id)) {
+      m_disabled.insert(id);
+      m_worklist.push_back(id);
+    }
+  }
+
+  void
+  disable_children(std::uint32_t id)
+  {
+    if (m_base.m_closed[id] || !m_closed.insert(id).second) {
+      return;
+    }
+
+    const Node& node = m_graph.m_nodes[id];
+    for (auto child : node.m_children) {
+      disable(child);
+      if (m_graph.m_nodes[child].m_kind == node.m_kind) {
+        disable_children(child);
+      }
+    }
+  }
+
+  // the counter is initialized on first access, when the first child disabled by the overlay is dequeued
+  std::size_t&
+  num_of_enabled(std::uint32_t idx)
+  {
+    auto it = m_num_of_enabled.find(idx);
+
+    if (it == m_num_of_enabled.end()) {
+      std::size_t count(0);
+      for (auto child : m_graph.m_nodes[m_graph.m_sets[idx].m_node].m_children) {
+        if (m_base.m_disabled[child] == 0) {
+          count++;
+        }
+      }
+      it = m_num_of_enabled.emplace(idx, count).first;
+    }
+
+    return it->second;
+  }
+
+  const DisabledSnapshot& m_base;
+  const Graph& m_graph;
+  std::unordered_set<std::uint32_t> m_disabled;
+  std::unordered_set<std::uint32_t> m_closed;
+  std::unordered_map<std::uint32_t, std::size_t> m_num_of_enabled;
+  std::vector<std::uint32_t> m_worklist;
+
+};
+
+  // the session graph may be shared by readers, so it is never modified after this call
+
+std::shared_ptr<const DisabledComponents::Graph>
+DisabledComponents::get_graph()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  if (m_session_changed) {
+    apply_session_changes();
+  }
+
+  if (!m_graph) {
+    build_graph();
+  }
+
+  m_graph_published = true;
+
+  return m_graph;
+}
+
+  // same rules as Session::get_enabled_applications() always had: the top segment is not tested,
+  // applications of disabled nested segments are skipped, non-component applications are enabled
+
+template<class F, class V>
+bool
+DisabledComponents::visit_applications(const Graph& graph, std::uint32_t id, F is_disabled, V& visitor)
+{
+  const Node& node = graph.m_nodes[id];
+
+  for (auto & app : node.m_applications) {
+    if (app.second == Graph::npos || !is_disabled(app.second)) {
+      if (!visitor(app.first)) {
+        return false;
+      }
+    }
+  }
+
+  for (auto child : node.m_children) {
+    if (graph.m_nodes[child].m_kind == Node::segment && !is_disabled(child)) {
+      if (!visit_applications(graph, child, is_disabled, visitor)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+  // the list of all applications is calculated with the graph; the list of enabled ones
+  // is calculated once per generation
+
+std::shared_ptr<const std::vector<const Application *>>
+DisabledComponents::get_applications(bool enabled_only)
+{
+  if (enabled_only) {
+    auto snapshot = get_snapshot();
+
+    // no graph in the snapshot means there are no disabled components
+    if (snapshot->m_graph) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      if (!m_enabled_applications || m_enabled_applications_generation != snapshot->m_generation) {
+        auto apps = std::make_shared<std::vector<const Application *>>();
+        apps->reserve(snapshot->m_graph->m_applications->size());
+        auto add = [&apps](const Application * app) { apps->push_back(app); return true; };
+        visit_applications(*snapshot->m_graph, 0, [&snapshot](std::uint32_t id) { return (snapshot->m_disabled[id] != 0); }, add);
+        m_enabled_applications = std::move(apps);
+        m_enabled_applications_generation = snapshot->m_generation;
+      }
+
+      return m_enabled_applications;
+    }
+  }
+
+  return get_graph()->m_applications;
+}
+
+void
+DisabledComponents::for_each_application(const std::function<bool(const Application&)>& visitor, bool enabled_only)
+{
+  std::shared_ptr<const DisabledSnapshot> snapshot;
+  std::shared_ptr<const Graph> graph;
+
+  if (enabled_only) {
+    snapshot = get_snapshot();
+    graph = snapshot->m_graph;
+  }
+
+  if (!graph) {
+    snapshot.reset();
+    graph = get_graph();
+  }
+
+  auto visit = [&visitor](const Application * app) { return visitor(*app); };
+  visit_applications(*graph, 0, [&snapshot](std::uint32_t id) { return (snapshot && snapshot->m_disabled[id] != 0); }, visit);
+}
+
+  // all paths from the session's segment to the component, in the order of segments and
+  // resource sets relationships (nested segments of a segment first, then its applications);
+  // the paths are enumerated walking up the parents of the graph nodes, so only the component's
+  // ancestors are visited
+
+void
+DisabledComponents::get_parents(const Component& c, std::list<std::vector<const Component *>>& parents)
+{
+  const auto graph(get_graph());
+
+  const std::uint32_t target = graph->find(&c);
+
+  if (target == Graph::npos) {
+    return;
+  }
+
+  if (target == 0) {
+    parents.emplace_back();
+    return;
+  }
+
+  const bool is_segment = (graph->m_nodes[target].m_type & Node::is_segment);
+
+  // position of the child in the order it is visited from the parent
+  auto rank = [&graph](std::uint32_t parent, std::uint32_t child) -> std::size_t {
+    const Node& node = graph->m_nodes[parent];
+    std::size_t pos(0);
+    if (node.m_kind == Node::segment) {
+      for (auto x : node.m_children) {
+        if (graph->m_nodes[x].m_kind == Node::segment) {
+          if (x == child) {
+            return pos;
+          }
+          pos++;
+        }
+      }
+      for (auto x : node.m_children) {
+        if (graph->m_nodes[x].m_kind != Node::segment) {
+          if (x == child) {
+            return pos;
+          }
+          pos++;
+        }
+      }
+    }
+    else {
+      for (auto x : node.m_children) {
+        if (x == child) {
+          return pos;
+        }
+        pos++;
+      }
+    }
+    return pos;
+  };
+
+  // paths found walking up, as nodes from the component's parent to the session's segment;
+  // cycles reachable from the session's segment were rejected by find_sets(), others lead nowhere
+  std::vector<std::vector<std::uint32_t>> paths;
+  std::vector<std::uint32_t> path;
+  std::vector<std::uint8_t> on_path(graph->m_nodes.size(), 0);
+
+  auto walk = [&](auto& self, std::uint32_t id) -> void {
+    if (on_path[id]) {
+      return;
+    }
+
+    path.push_back(id);
+
+    if (id == 0) {
+      paths.push_back(path);
+    }
+    else {
+      on_path[id] = 1;
+      for (auto p : graph->m_nodes[id].m_parents) {
+        if (Node::is_followed(graph->m_nodes[p].m_kind, graph->m_nodes[id].m_kind)) {
+          self(self, p);
+        }
+      }
+      on_path[id] = 0;
+    }
+
+    path.pop_back();
+  };
+
+  for (auto p : graph->m_nodes[target].m_parents) {
+    // a segment is a child of its parent segment only
+    if (!is_segment || graph->m_nodes[p].m_kind == Node::segment) {
+      walk(walk, p);
+    }
+  }
+
+  // order the paths as the depth-first search from the session's segment finds them
+  std::vector<std::pair<std::vector<std::size_t>, std::size_t>> keys;
+  keys.reserve(paths.size());
+  for (std::size_t i = 0; i < paths.size(); ++i) {
+    const auto& x = paths[i];
+    std::vector<std::size_t> key;
+    key.reserve(x.size());
+    for (std::size_t j = x.size(); j-- > 0;) {
+      key.push_back(rank(x[j], j > 0 ? x[j - 1] : target));
+    }
+    keys.emplace_back(std::move(key), i);
+  }
+  std::sort(keys.begin(), keys.end());
+
+  for (const auto& k : keys) {
+    const auto& x = paths[k.second];
+    parents.emplace_back();
+    auto& v = parents.back();
+    v.reserve(x.size());
+    for (auto it = x.rbegin(); it != x.rend(); ++it) {
+      v.push_back(graph->m_nodes[*it].m_obj);
+    }
+  }
+}
+
+  // same paths as get_parents() for every component of the session, found by single
+  // depth-first search from the session's segment (the graph has no cycles, see find_sets())
+
+void
+DisabledComponents::get_all_parents(std::unordered_map<const Component *, std::list<std::vector<const Component *>>>& parents)
+{
+  const auto graph(get_graph());
+
+  std::vector<const Component *> path;
+
+  parents[graph->m_nodes[0].m_obj].emplace_back();
+
+  auto walk = [&](auto& self, std::uint32_t id) -> void {
+    const Node& node = graph->m_nodes[id];
+
+    path.push_back(node.m_obj);
+
+    auto visit = [&](std::uint32_t child) {
+      const Node& c = graph->m_nodes[child];
+
+      // a segment is a child of its parent segment only
+      if (c.m_kind != Node::segment || node.m_kind == Node::segment) {
+        parents[c.m_obj].push_back(path);
+      }
+
+      if (Node::is_followed(node.m_kind, c.m_kind)) {
+        self(self, child);
+      }
+    };
+
+    if (node.m_kind == Node::segment) {
+      for (auto child : node.m_children) {
+        if (graph->m_nodes[child].m_kind == Node::segment) {
+          visit(child);
+        }
+      }
+
+      for (auto child : node.m_children) {
+        if (graph->m_nodes[child].m_kind != Node::segment) {
+          visit(child);
+        }
+      }
+    }
+    else {
+      for (auto child : node.m_children) {
+        visit(child);
+      }
+    }
+
+    path.pop_back();
+  };
+
+  walk(walk, 0);
+}
+
+std::vector<WhatIfResult>
+DisabledComponents::evaluate(const std::vector<std::set<const Component *>>& candidates)
+{
+  std::shared_ptr<const DisabledSnapshot> base;
+
+  // make sure the state is calculated and the graph contains all candidates
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_session_changed) {
+      apply_session_changes();
+    }
+
+    if (!m_computed) {
+      compute();
+    }
+
+    const std::size_t num_of_nodes(m_graph->m_nodes.size());
+
+    for (auto & candidate : candidates) {
+      for (auto & c : candidate) {
+        add_to_graph(get_node(*c));
+      }
+    }
+
+    if (m_graph->m_nodes.size() != num_of_nodes) {
+      publish();
+    }
+
+    base = std::atomic_load(&m_snapshot);
+  }
+
+  const Graph& graph = *base->m_graph;
+
+  // the database is only accessed here, the candidates are evaluated using the graph only
+  // (the DetectorStream objects are taken from the database cache)
+
+  std::vector<std::vector<std::uint32_t>> seeds;
+  seeds.reserve(candidates.size());
+  for (auto & candidate : candidates) {
+    seeds.emplace_back();
+    for (auto & c : candidate) {
+      seeds.back().push_back(graph.find(c));
+    }
+  }
+
+  std::vector<std::pair<std::uint32_t, const DetectorStream *>> streams;
+  {
+    std::vector<std::uint8_t> visited(graph.m_nodes.size(), 0);
+    std::vector<std::uint32_t> stack{0};
+    visited[0] = 1;
+
+    while (!stack.empty()) {
+      const std::uint32_t id = stack.back();
+      stack.pop_back();
+
+      if (graph.m_nodes[id].m_type & Node::is_detector_stream) {
+        streams.emplace_back(id, graph.m_nodes[id].m_obj->cast<DetectorStream>());
+      }
+
+      for (auto child : graph.m_nodes[id].m_children) {
+        if (visited[child] == 0) {
+          visited[child] = 1;
+          stack.push_back(child);
+        }
+      }
+    }
+
+    std::sort(streams.begin(), streams.end());
+  }
+
+  TLOG_DEBUG(6) <<  "evaluate " << candidates.size() << " candidates using graph of " << graph.m_nodes.size() << " components and " << streams.size() << " detector streams" ;
+
+  std::vector<WhatIfResult> results(candidates.size());
+  std::atomic<std::size_t> next(0);
+
+  auto worker = [&]() {
+    for (std::size_t idx = next++; idx < seeds.size(); idx = next++) {
+      Overlay overlay(*base);
+
+      for (auto id : seeds[idx]) {
+        overlay.seed(id);
+      }
+
+      overlay.propagate();
+
+      WhatIfResult& result = results[idx];
+      auto add = [&result](const Application * app) { result.m_enabled_applications.push_back(app); return true; };
+      visit_applications(graph, 0, [&overlay](std::uint32_t id) { return overlay.is_disabled(id); }, add);
+      for (auto & s : streams) {
+        if (!overlay.is_disabled(s.first)) {
+          result.m_enabled_streams.push_back(s.second);
+        }
+      }
+    }
+  };
+
+  const std::size_t num_of_threads = std::min<std::size_t>(candidates.size(), std::max(1U, std::thread::hardware_concurrency()));
+
+  std::vector<std::future<void>> workers;
+  for (std::size_t i = 1; i < num_of_threads; ++i) {
+    workers.push_back(std::async(std::launch::async, worker));
+  }
+
+  worker();
+
+  for (auto & w : workers) {
+    w.get();
+  }
+
+  return results;
+}
+
+std::vector<WhatIfResult>
+Session::evaluate_disabled(const std::vector<std::set<const Component *>>& candidates) const
+{
+  return m_disabled_components.evaluate(candidates);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool
+Component::disabled(const Session& session) const
+{
+  TLOG_DEBUG( 6) << "Session UID: " << session.UID() << " this->UID()=" << UID();
+
+  // published state is read without locking; it is calculated on first use (e.g. after session changes)
+  const auto snapshot(session.m_disabled_components.get_snapshot());
+
+  bool result(snapshot->is_disabled(*this));
+  TLOG_DEBUG( 6) <<  "disabled(" << this << ")  (UID=" << UID() << ") returns " << std::boolalpha << result  ;
+  return result;
+}
+
+std::vector<DisabledReason>
+Component::disabled_reason(const Session& session) const
+{
+  return session.m_disabled_components.get_snapshot()->get_reason(*this);
 }
 
 unsigned long
@@ -0,0 +1,124 @@
+#include "confmodel/environment.hpp"
+
+#include "confmodel/Application.hpp"
+#include "confmodel/Session.hpp"
+#include "confmodel/Variable.hpp"
+#include "confmodel/VariableBase.hpp"
+#include "confmodel/VariableSet.hpp"
+#include "confmodel/util.hpp"
+
+#include "conffwk/ConfigObject.hpp"
+
+#include <algorithm>
+
+using namespace dunedaq::confmodel;
+
+  // insert keeps the value of a name defined before
+
+void
+EnvironmentResolver::add(const std::vector<const VariableBase *>& variables, Environment& env)
+{
+  for (auto v : variables) {
+    if (auto var = v->cast<Variable>()) {
+      env.emplace(var->get_name(), var->get_value());
+    }
+    else if (auto set = v->cast<VariableSet>()) {
+      const Environment& nested = flatten(*set);
+      env.insert(nested.begin(), nested.end());
+    }
+  }
+}
+
+const EnvironmentResolver::Environment&
+EnvironmentResolver::flatten(const VariableSet& set)
+{
+  const dunedaq::conffwk::ConfigObjectImpl * impl = set.config_object().implementation();
+
+  auto it = m_sets.find(impl);
+
+  if (it != m_sets.end()) {
+    return it->second;
+  }
+
+  auto cycle = std::find(m_path.begin(), m_path.end(), &set);
+
+  if (cycle != m_path.end()) {
+    std::string objects;
+    for (auto x = cycle; x != m_path.end(); ++x) {
+      objects += (*x)->full_name() + ", ";
+    }
+    objects += set.full_name();
+    throw FoundCircularDependency(ERS_HERE, static_cast<unsigned int>(m_path.end() - cycle), "environment of variable sets", objects);
+  }
+
+  Environment env;
+
+  m_path.push_back(&set);
+
+  try {
+    add(set.get_contains(), env);
+  }
+  catch (...) {
+    m_path.pop_back();
+    throw;
+  }
+
+  m_path.pop_back();
+
+  return m_sets.emplace(impl, std::move(env)).first->second;
+}
+
+std::shared_ptr<const EnvironmentResolver::Environment>
+EnvironmentResolver::get_session_environment()
+{
+  if (!m_session_environment) {
+    auto env = std::make_shared<Environment>();
+    add(m_session.get_environment(), *env);
+    m_session_environment = std::move(env);
+  }
+
+  return m_session_environment;
+}
+
+std::shared_ptr<const EnvironmentResolver::Environment>
+EnvironmentResolver::get_environment(const Application& app)
+{
+  const auto& variables = app.get_application_environment();
+
+  if (variables.empty()) {
+    return get_session_environment();
+  }
+
+  Key key;
+  key.reserve(variables.size());
+  for (auto v : variables) {
+    key.push_back(v->config_object().implementation());
+  }
+
+  auto it = m_environments.find(key);
+
+  if (it == m_environments.end()) {
+    auto env = std::make_shared<Environment>();
+    add(variables, *env);
+    const Environment& session_env = *get_session_environment();
+    env->insert(session_env.begin(), session_env.end());
+    it = m_environments.emplace(std::move(key), std::move(env)).first;
+  }
+
+  return it->second;
+}
+
+std::vector<std::pair<const Application *, std::shared_ptr<const EnvironmentResolver::Environment>>>
+EnvironmentResolver::get_environments()
+{
+  const auto apps = m_session.get_shared_applications(true);
+
+  std::vector<std::pair<const Application *, std::shared_ptr<const Environment>>> result;
+  result.reserve(apps->size());
+
+  for (auto app : *apps) {
+    result.emplace_back(app, get_environment(*app));
+  }
+
+  return result;
+}
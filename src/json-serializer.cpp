@@ -0,0 +1,601 @@
+#include "confmodel/DaqApplication.hpp"
+#include "confmodel/DaqModule.hpp"
+#include "confmodel/Segment.hpp"
+#include "confmodel/Session.hpp"
+#include "confmodel/json-serializer.hpp"
+#include "confmodel/util.hpp"
+
+#include "conffwk/Schema.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+
+using namespace dunedaq::conffwk;
+using namespace dunedaq::confmodel;
+
+  // the accessor of every attribute type is instantiated at build time
+
+const JsonSerializer::ClassPlan&
+JsonSerializer::get_plan(const std::string& class_name)
+{
+  auto it = m_plans.find(class_name);
+
+  if (it != m_plans.end()) {
+    return it->second;
+  }
+
+  using add_t = void (*)(ConfigObject&, const std::string&, bool, nlohmann::json&);
+
+  auto accessor = [](type_t type) -> add_t {
+    switch (type) {
+      case type_t::u8_type:     return &add_json_value<uint8_t>;
+      case type_t::u16_type:    return &add_json_value<uint16_t>;
+      case type_t::u32_type:    return &add_json_value<uint32_t>;
+      case type_t::u64_type:    return &add_json_value<uint64_t>;
+      case type_t::s8_type:     return &add_json_value<int8_t>;
+      case type_t::s16_type:    return &add_json_value<int16_t>;
+      case type_t::s32_type:    return &add_json_value<int32_t>;
+      case type_t::s64_type:    return &add_json_value<int64_t>;
+      case type_t::float_type:  return &add_json_value<float>;
+      case type_t::double_type: return &add_json_value<double>;
+      case type_t::bool_type:   return &add_json_value<bool>;
+      case type_t::string_type:
+      case type_t::enum_type:
+      case type_t::date_type:
+      case type_t::time_type:   return &add_json_value<std::string>;
+      default:                  return nullptr; // e.g. class references are not serialized
+    }
+  };
+
+  const class_t& class_info = m_db.get_class_info(class_name);
+
+  ClassPlan plan;
+
+  auto is_projected = [](const std::set<std::string>& include, const std::set<std::string>& exclude, const std::string& name) {
+    return ((include.empty() || include.count(name)) && !exclude.count(name));
+  };
+
+  plan.m_attributes.reserve(class_info.p_attributes.size());
+  for (const auto& attr : class_info.p_attributes) {
+    if (!is_projected(m_options.m_include_attributes, m_options.m_exclude_attributes, attr.p_name)) {
+      continue;
+    }
+    if (auto add = accessor(attr.p_type)) {
+      plan.m_attributes.push_back({attr.p_name, attr.p_is_multi_value, add});
+    }
+  }
+
+  // an object is projected, if its class or any superclass is included and none is excluded
+  plan.m_included = m_options.m_include_classes.empty() || m_options.m_include_classes.count(class_name);
+  bool excluded = m_options.m_exclude_classes.count(class_name);
+  for (const auto& c : class_info.p_superclasses) {
+    plan.m_included = plan.m_included || m_options.m_include_classes.count(c);
+    excluded = excluded || m_options.m_exclude_classes.count(c);
+  }
+  plan.m_included = plan.m_included && !excluded;
+
+  plan.m_relationships.reserve(class_info.p_relationships.size());
+  for (const auto& rel : class_info.p_relationships) {
+    plan.m_relationships.push_back({rel.p_name, (rel.p_cardinality == cardinality_t::zero_or_one || rel.p_cardinality == cardinality_t::only_one)});
+  }
+
+  // nlohmann::json objects are ordered by keys
+  for (std::size_t i = 0; i < plan.m_attributes.size(); ++i) {
+    plan.m_keys.emplace_back(true, i);
+  }
+  for (std::size_t i = 0; i < plan.m_relationships.size(); ++i) {
+    plan.m_keys.emplace_back(false, i);
+  }
+  auto name = [&plan](const std::pair<bool, std::size_t>& k) -> const std::string& {
+    return (k.first ? plan.m_attributes[k.second].m_name : plan.m_relationships[k.second].m_name);
+  };
+  std::stable_sort(plan.m_keys.begin(), plan.m_keys.end(), [&name](const auto& a, const auto& b) { return name(a) < name(b); });
+
+  return m_plans.emplace(class_name, std::move(plan)).first->second;
+}
+
+JsonSerializer::JsonSerializer(Configuration& db, const JsonOptions& options) :
+  m_db(db),
+  m_options(options),
+  m_use_cache(!options.m_references && options.m_relationships.empty() && options.m_max_depth == JsonOptions::unlimited)
+{
+  // a relationship is followed, if its path is given or it leads to a given one
+  for (const auto& path : m_options.m_relationships) {
+    for (std::size_t pos = path.find('.'); pos != std::string::npos; pos = path.find('.', pos + 1)) {
+      m_paths.insert(path.substr(0, pos));
+    }
+    m_paths.insert(path);
+  }
+}
+
+nlohmann::json
+JsonSerializer::serialize(const ConfigObject& obj)
+{
+  m_path.clear();
+  m_relationship_path.clear();
+
+  ConfigObject o(obj);
+  return get_value(o);
+}
+
+bool
+JsonSerializer::push_relationship(const std::string& name)
+{
+  if (m_paths.empty()) {
+    return true;
+  }
+
+  const std::size_t length(m_relationship_path.size());
+
+  if (length) {
+    m_relationship_path.push_back('.');
+  }
+  m_relationship_path.append(name);
+
+  if (m_paths.count(m_relationship_path) == 0) {
+    m_relationship_path.resize(length);
+    return false;
+  }
+
+  return true;
+}
+
+void
+JsonSerializer::pop_relationship()
+{
+  if (!m_paths.empty()) {
+    const auto pos = m_relationship_path.rfind('.');
+    m_relationship_path.resize(pos == std::string::npos ? 0 : pos);
+  }
+}
+
+bool
+JsonSerializer::is_included(const ConfigObject& obj)
+{
+  if (m_options.m_include_classes.empty() && m_options.m_exclude_classes.empty()) {
+    return true;
+  }
+
+  return get_plan(obj.class_name()).m_included;
+}
+
+  // returns false, if the object is to be replaced by reference to its previous occurrence;
+  // otherwise the object is put on the path after test of circular dependency of inlined objects
+
+bool
+JsonSerializer::enter(ConfigObject& obj)
+{
+  const ConfigObjectImpl * impl = obj.implementation();
+
+  if (m_options.m_references) {
+    if (!m_serialized.insert(impl).second) {
+      return false;
+    }
+  }
+  else {
+    auto cycle = std::find_if(m_path.begin(), m_path.end(), [impl](const ConfigObject& x) { return x.implementation() == impl; });
+
+    if (cycle != m_path.end()) {
+      std::ostringstream s;
+      for (auto x = cycle; x != m_path.end(); ++x) {
+        s << x->UID() << '@' << x->class_name() << ", ";
+      }
+      s << obj.UID() << '@' << obj.class_name();
+      throw FoundCircularDependency(ERS_HERE, m_path.end() - cycle, "JSON configuration", s.str());
+    }
+  }
+
+  m_path.push_back(obj);
+
+  return true;
+}
+
+  // value of relationship: the object inlined as {"uid": {...}}, or reference to already serialized one
+
+nlohmann::json
+JsonSerializer::get_value(ConfigObject& obj)
+{
+  const ConfigObjectImpl * impl = obj.implementation();
+
+  // the object is not in the cache until all its relationships are serialized
+  if (m_use_cache) {
+    auto it = m_cache.find(impl);
+
+    if (it != m_cache.end()) {
+      return it->second;
+    }
+  }
+
+  if (!enter(obj)) {
+    return nlohmann::json{{"$ref", obj.UID() + '@' + obj.class_name()}};
+  }
+
+  nlohmann::json value;
+
+  try {
+    value[obj.UID()] = get_attributes(obj);
+  }
+  catch (...) {
+    m_path.pop_back();
+    throw;
+  }
+
+  m_path.pop_back();
+
+  if (m_use_cache) {
+    m_cache.emplace(impl, value);
+  }
+
+  return value;
+}
+
+nlohmann::json
+JsonSerializer::get_attributes(ConfigObject& obj)
+{
+  TLOG_DBG(9) << "Getting attributes for " << obj.UID() << " of class " << obj.class_name();
+
+  nlohmann::json attributes;
+  const ClassPlan& plan = get_plan(obj.class_name());
+
+  for (const auto& attr : plan.m_attributes) {
+    attr.m_add(obj, attr.m_name, attr.m_is_multi_value, attributes);
+  }
+
+  if (follow_relationships()) {
+    TLOG_DBG(9) << "Processing  relationships";
+    for (const auto& rel : plan.m_relationships) {
+      if (!push_relationship(rel.m_name)) {
+        continue;
+      }
+      if (rel.m_is_single_value) {
+        ConfigObject rel_obj;
+        obj.get(rel.m_name, rel_obj);
+        if (!rel_obj.is_null() && is_included(rel_obj)) {
+          attributes[rel.m_name] = get_value(rel_obj);
+        }
+        else {
+          TLOG_DBG(9) << "Relationship " << rel.m_name << " not set";
+        }
+      }
+      else {
+        std::vector<ConfigObject> rel_vec;
+        obj.get(rel.m_name, rel_vec);
+        std::vector<nlohmann::json> configs;
+        configs.reserve(rel_vec.size());
+        for (auto& rel_obj : rel_vec) {
+          if (is_included(rel_obj)) {
+            configs.push_back(get_value(rel_obj));
+          }
+        }
+        attributes[rel.m_name] = configs;
+      }
+      pop_relationship();
+    }
+  }
+
+  return attributes;
+}
+
+  // the output is formatted exactly as nlohmann::json::dump() does
+
+void
+JsonSerializer::write(const ConfigObject& obj, std::ostream& out, int indent, unsigned int level)
+{
+  m_path.clear();
+  m_relationship_path.clear();
+
+  ConfigObject o(obj);
+  write_value(o, out, indent, level);
+}
+
+void
+JsonSerializer::newline(std::ostream& out, int indent, unsigned int level) const
+{
+  if (indent >= 0) {
+    out << '\n';
+    for (unsigned int i = 0; i < indent * level; ++i) {
+      out << ' ';
+    }
+  }
+}
+
+void
+JsonSerializer::write_value(ConfigObject& obj, std::ostream& out, int indent, unsigned int level)
+{
+  const char * separator = (indent >= 0 ? ": " : ":");
+
+  if (!enter(obj)) {
+    out << '{';
+    newline(out, indent, level + 1);
+    out << "\"$ref\"" << separator << nlohmann::json(obj.UID() + '@' + obj.class_name()).dump();
+    newline(out, indent, level);
+    out << '}';
+    return;
+  }
+
+  try {
+    out << '{';
+    newline(out, indent, level + 1);
+    out << nlohmann::json(obj.UID()).dump() << separator;
+    write_attributes(obj, out, indent, level + 1);
+    newline(out, indent, level);
+    out << '}';
+  }
+  catch (...) {
+    m_path.pop_back();
+    throw;
+  }
+
+  m_path.pop_back();
+}
+
+  // an object without attributes and set relationships is null
+
+void
+JsonSerializer::write_attributes(ConfigObject& obj, std::ostream& out, int indent, unsigned int level)
+{
+  const ClassPlan& plan = get_plan(obj.class_name());
+  const bool follow(follow_relationships());
+
+  bool empty(true);
+
+  auto key = [&](const std::string& name) {
+    out << (empty ? '{' : ',');
+    empty = false;
+    newline(out, indent, level + 1);
+    out << nlohmann::json(name).dump() << (indent >= 0 ? ": " : ":");
+  };
+
+  for (const auto& k : plan.m_keys) {
+    if (k.first) {
+      const auto& attr = plan.m_attributes[k.second];
+      nlohmann::json value;
+      attr.m_add(obj, attr.m_name, attr.m_is_multi_value, value);
+      key(attr.m_name);
+
+      // only multi-value attributes are printed on several lines
+      for (char c : value[attr.m_name].dump(indent)) {
+        out << c;
+        if (c == '\n') {
+          for (unsigned int i = 0; i < indent * (level + 1); ++i) {
+            out << ' ';
+          }
+        }
+      }
+    }
+    else if (follow && push_relationship(plan.m_relationships[k.second].m_name)) {
+      const auto& rel = plan.m_relationships[k.second];
+      if (rel.m_is_single_value) {
+        ConfigObject rel_obj;
+        obj.get(rel.m_name, rel_obj);
+        if (!rel_obj.is_null() && is_included(rel_obj)) {
+          key(rel.m_name);
+          write_value(rel_obj, out, indent, level + 1);
+        }
+      }
+      else {
+        std::vector<ConfigObject> rel_vec;
+        obj.get(rel.m_name, rel_vec);
+        key(rel.m_name);
+        bool first(true);
+        for (auto& rel_obj : rel_vec) {
+          if (is_included(rel_obj)) {
+            out << (first ? '[' : ',');
+            first = false;
+            newline(out, indent, level + 2);
+            write_value(rel_obj, out, indent, level + 2);
+          }
+        }
+        if (first) {
+          out << "[]";
+        }
+        else {
+          newline(out, indent, level + 1);
+          out << ']';
+        }
+      }
+      pop_relationship();
+    }
+  }
+
+  if (empty) {
+    out << "null";
+  }
+  else {
+    newline(out, indent, level);
+    out << '}';
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+  // items of the session export in output order; DAL objects are only accessed by the calling thread
+
+  struct SessionItems
+  {
+    std::vector<std::pair<const char *, std::vector<ConfigObject>>> m_groups;
+    ConfigObject m_session;
+
+    explicit SessionItems(const Session& session) :
+      m_session(session.config_object())
+    {
+      std::vector<ConfigObject> applications, modules, segments;
+      std::unordered_set<const DaqModule *> known_modules;
+      std::unordered_set<const Segment *> known_segments;
+
+      for (auto app : session.get_all_applications()) {
+        applications.push_back(app->config_object());
+        if (auto daq_app = app->cast<DaqApplication>()) {
+          for (auto mod : daq_app->get_modules()) {
+            if (known_modules.insert(mod).second) {
+              modules.push_back(mod->config_object());
+            }
+          }
+        }
+      }
+
+      std::vector<const Segment *> stack{session.get_segment()};
+      while (!stack.empty()) {
+        const Segment * seg = stack.back();
+        stack.pop_back();
+        if (known_segments.insert(seg).second) {
+          segments.push_back(seg->config_object());
+          const auto& nested = seg->get_segments();
+          stack.insert(stack.end(), nested.rbegin(), nested.rend());
+        }
+      }
+
+      // keys of nlohmann::json objects are sorted
+      m_groups.emplace_back("applications", std::move(applications));
+      m_groups.emplace_back("modules", std::move(modules));
+      m_groups.emplace_back("segments", std::move(segments));
+    }
+
+    template<class F>
+    void
+    for_each(F f)
+    {
+      for (auto& g : m_groups) {
+        for (auto& obj : g.second) {
+          f(obj);
+        }
+      }
+    }
+  };
+
+    // serialize all items using a pool of threads; a thread has own serializer, the results are stored by item index;
+    // references are reset for every item, so the result does not depend on which thread serialized which items
+
+  template<class T, class F>
+  std::vector<T>
+  serialize_items(dunedaq::conffwk::Configuration& db, SessionItems& items, const JsonOptions& options, unsigned int num_of_threads, F serialize)
+  {
+    std::vector<const ConfigObject *> objects;
+    items.for_each([&objects](const ConfigObject& obj) { objects.push_back(&obj); });
+
+    std::vector<T> results(objects.size());
+    std::atomic<std::size_t> next(0);
+
+    auto worker = [&]() {
+      JsonSerializer serializer(db, options);
+      for (std::size_t idx = next++; idx < objects.size(); idx = next++) {
+        serializer.reset_references();
+        results[idx] = serialize(serializer, *objects[idx]);
+      }
+    };
+
+    if (num_of_threads == 0) {
+      num_of_threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    num_of_threads = static_cast<unsigned int>(std::min<std::size_t>(num_of_threads, std::max<std::size_t>(1, objects.size())));
+
+    std::vector<std::future<void>> workers;
+    for (unsigned int i = 1; i < num_of_threads; ++i) {
+      workers.push_back(std::async(std::launch::async, worker));
+    }
+
+    worker();
+
+    for (auto & w : workers) {
+      w.get();
+    }
+
+    return results;
+  }
+
+  JsonOptions
+  session_options(const JsonOptions& options)
+  {
+    JsonOptions session_options(options);
+    session_options.m_direct_only = true;
+    return session_options;
+  }
+
+}
+
+nlohmann::json
+dunedaq::confmodel::export_session(Configuration& db, const Session& session, const JsonOptions& options, unsigned int num_of_threads)
+{
+  SessionItems items(session);
+
+  auto results = serialize_items<nlohmann::json>(db, items, options, num_of_threads, [](JsonSerializer& serializer, const ConfigObject& obj) {
+    return serializer.serialize(obj);
+  });
+
+  nlohmann::json json_config;
+  std::size_t idx(0);
+
+  for (const auto& g : items.m_groups) {
+    std::vector<nlohmann::json> configs;
+    configs.reserve(g.second.size());
+    for (std::size_t i = 0; i < g.second.size(); ++i) {
+      configs.push_back(std::move(results[idx++]));
+    }
+    json_config[g.first] = configs;
+  }
+
+  json_config["session"] = JsonSerializer(db, session_options(options)).serialize(items.m_session);
+
+  return json_config;
+}
+
+void
+dunedaq::confmodel::write_session(Configuration& db, const Session& session, std::ostream& out, const JsonOptions& options, int indent, unsigned int num_of_threads)
+{
+  SessionItems items(session);
+
+  // an item is an element of array of the top object
+  auto results = serialize_items<std::string>(db, items, options, num_of_threads, [indent](JsonSerializer& serializer, const ConfigObject& obj) {
+    std::ostringstream s;
+    serializer.write(obj, s, indent, 2);
+    return s.str();
+  });
+
+  auto newline = [&out, indent](unsigned int level) {
+    if (indent >= 0) {
+      out << '\n' << std::string(indent * level, ' ');
+    }
+  };
+
+  const char * separator = (indent >= 0 ? ": " : ":");
+  std::size_t idx(0);
+
+  out << '{';
+
+  for (const auto& g : items.m_groups) {
+    newline(1);
+    out << '"' << g.first << '"' << separator;
+    if (g.second.empty()) {
+      out << "[]";
+    }
+    else {
+      out << '[';
+      for (std::size_t i = 0; i < g.second.size(); ++i) {
+        if (i) {
+          out << ',';
+        }
+        newline(2);
+        out << results[idx++];
+      }
+      newline(1);
+      out << ']';
+    }
+    out << ',';
+  }
+
+  newline(1);
+  out << "\"session\"" << separator;
+  JsonSerializer(db, session_options(options)).write(items.m_session, out, indent, 1);
+  newline(0);
+  out << '}';
+}
@@ -0,0 +1,111 @@
+#include "confmodel/launch-plan.hpp"
+
+#include "confmodel/Application.hpp"
+#include "confmodel/Component.hpp"
+#include "confmodel/DaqApplication.hpp"
+#include "confmodel/PhysicalHost.hpp"
+#include "confmodel/RCApplication.hpp"
+#include "confmodel/Segment.hpp"
+#include "confmodel/Service.hpp"
+#include "confmodel/Session.hpp"
+#include "confmodel/VirtualHost.hpp"
+#include "confmodel/command-line.hpp"
+#include "confmodel/util.hpp"
+
+#include "conffwk/Configuration.hpp"
+
+#include <unordered_set>
+
+using namespace dunedaq::confmodel;
+
+LaunchPlan::LaunchPlan(const dunedaq::conffwk::Configuration& confdb, const Session& session) :
+  m_session_id(intern(session.UID())),
+  m_configuration_uri(intern(confdb.get_impl_spec())),
+  m_controller_log_level(intern(session.get_controller_log_level()))
+{
+  CommandLineExpander expander(&session);
+
+  for (auto app : session.get_infrastructure_applications()) {
+    auto c = app->cast<Component>();
+    if (c == nullptr || !c->disabled(session)) {
+      add(*app, expander);
+    }
+  }
+
+  const auto enabled = session.get_shared_applications(true);
+  const std::unordered_set<const Application *> enabled_set(enabled->begin(), enabled->end());
+
+  m_entries.reserve(m_entries.size() + enabled->size());
+
+  // same walk as Session::get_enabled_applications(), adding the controllers of segments
+  std::vector<const Segment *> stack(1, session.get_segment());
+
+  while (!stack.empty()) {
+    const Segment * seg = stack.back();
+    stack.pop_back();
+
+    add(*seg->get_controller(), expander);
+
+    for (auto app : seg->get_applications()) {
+      if (enabled_set.count(app)) {
+        add(*app, expander);
+      }
+    }
+
+    const auto& segments = seg->get_segments();
+    for (auto it = segments.rbegin(); it != segments.rend(); ++it) {
+      if (!(*it)->disabled(session)) {
+        stack.push_back(*it);
+      }
+    }
+  }
+}
+
+std::string_view
+LaunchPlan::intern(std::string_view s)
+{
+  auto it = m_index.find(s);
+
+  if (it == m_index.end()) {
+    it = m_index.insert(m_strings.emplace_back(s)).first;
+  }
+
+  return *it;
+}
+
+void
+LaunchPlan::add(const Application& app, CommandLineExpander& expander)
+{
+  Entry entry;
+  entry.m_application = &app;
+  entry.m_executable = intern(app.get_application_name());
+  entry.m_host = intern(app.get_runs_on()->get_runs_on()->UID());
+
+  const Service * control_service = get_control_service(app);
+
+  if (control_service) {
+    entry.m_control_uri = m_strings.emplace_back(get_control_uri(app, *control_service));
+  }
+
+  if (app.cast<RCApplication>() || app.cast<DaqApplication>()) {
+    if (control_service == nullptr) {
+      throw NoControlServiceDefined(ERS_HERE, app.UID());
+    }
+
+    const std::string_view uid = intern(app.UID());
+
+    if (app.cast<RCApplication>()) {
+      entry.m_arguments = make_rc_application_arguments(m_controller_log_level, m_configuration_uri, entry.m_control_uri, uid, m_session_id);
+    }
+    else {
+      entry.m_arguments = make_daq_application_arguments(m_session_id, uid, entry.m_control_uri, m_configuration_uri);
+    }
+  }
+  else {
+    for (const auto& x : expander.expand(app)) {
+      entry.m_arguments.push_back(intern(x));
+    }
+  }
+
+  m_entries.push_back(std::move(entry));
+}
@@ -0,0 +1,617 @@
+#include "confmodel/resolved-session.hpp"
+
+#include "confmodel/Application.hpp"
+#include "confmodel/Component.hpp"
+#include "confmodel/Connection.hpp"
+#include "confmodel/DaqApplication.hpp"
+#include "confmodel/DaqModule.hpp"
+#include "confmodel/DetDataReceiver.hpp"
+#include "confmodel/DetDataSender.hpp"
+#include "confmodel/DetectorStream.hpp"
+#include "confmodel/DetectorToDaqConnection.hpp"
+#include "confmodel/GeoId.hpp"
+#include "confmodel/NetworkConnection.hpp"
+#include "confmodel/PhysicalHost.hpp"
+#include "confmodel/RCApplication.hpp"
+#include "confmodel/ResourceSet.hpp"
+#include "confmodel/Segment.hpp"
+#include "confmodel/Service.hpp"
+#include "confmodel/Session.hpp"
+#include "confmodel/VirtualHost.hpp"
+#include "confmodel/util.hpp"
+
+#include "conffwk/Configuration.hpp"
+
+#include "nlohmann/json.hpp"
+
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+using namespace dunedaq::confmodel;
+
+  // set by the build from the package version
+
+#ifndef CONFMODEL_SCHEMA_VERSION
+#error "CONFMODEL_SCHEMA_VERSION is not defined"
+#endif
+
+namespace {
+
+  const char * const format_name = "confmodel-resolved-session";
+
+  class Resolver
+  {
+
+  public:
+
+    Resolver(const dunedaq::conffwk::Configuration& db, const Session& session) :
+      m_db(db),
+      m_session(session)
+    {
+      for (auto app : session.get_enabled_applications()) {
+        m_enabled_applications.insert(app);
+      }
+    }
+
+    ResolvedSession
+    run()
+    {
+      m_result.m_uid = m_session.UID();
+      m_result.m_schema_version = ResolvedSession::get_schema_version();
+      m_result.m_source = m_db.get_impl_spec();
+      m_result.m_segment = add_segment(m_session.get_segment(), true);
+
+      for (auto app : m_session.get_infrastructure_applications()) {
+        add_application(app, enabled(app->cast<Component>()));
+      }
+
+      return std::move(m_result);
+    }
+
+  private:
+
+    // the index of the object in the table; a new object is appended to the table before its fields
+    // are filled, so objects referenced by it (e.g. nested segments) follow it
+
+    template<class T, class D, class F>
+    static std::uint32_t
+    add(std::unordered_map<const D *, std::uint32_t>& index, std::vector<T>& table, const D * obj, F fill)
+    {
+      if (obj == nullptr) {
+        return ResolvedSession::npos;
+      }
+
+      auto it = index.emplace(obj, table.size());
+
+      if (it.second) {
+        table.emplace_back();
+        T item;
+        fill(item);
+        table[it.first->second] = std::move(item);
+      }
+
+      return it.first->second;
+    }
+
+    bool
+    enabled(const Component * obj) const
+    {
+      return (obj == nullptr || !obj->disabled(m_session));
+    }
+
+    std::uint32_t
+    add_segment(const Segment * seg, bool parent_enabled)
+    {
+      return add(m_segments, m_result.m_segments, seg, [&](ResolvedSession::Segment& item) {
+        item.m_uid = seg->UID();
+        item.m_enabled = parent_enabled && enabled(seg);
+        item.m_controller = add_application(seg->get_controller(), item.m_enabled);
+        for (auto app : seg->get_applications()) {
+          item.m_applications.push_back(add_application(app, m_enabled_applications.count(app) != 0));
+        }
+        for (auto s : seg->get_segments()) {
+          item.m_segments.push_back(add_segment(s, item.m_enabled));
+        }
+      });
+    }
+
+    std::uint32_t
+    add_application(const Application * app, bool is_enabled)
+    {
+      return add(m_applications, m_result.m_applications, app, [&](ResolvedSession::Application& item) {
+        item.m_uid = app->UID();
+        item.m_class = app->class_name();
+        item.m_application_name = app->get_application_name();
+        item.m_commandline_parameters = app->get_commandline_parameters();
+        item.m_enabled = is_enabled;
+        item.m_host = add_host(app->get_runs_on());
+        for (auto service : app->get_exposes_service()) {
+          item.m_services.push_back(add_service(service));
+        }
+        if (auto daq_app = app->cast<DaqApplication>()) {
+          for (auto mod : daq_app->get_modules()) {
+            item.m_modules.push_back(add_module(mod));
+          }
+        }
+        if (auto res = app->cast<ResourceSet>()) {
+          add_readout_map(res);
+        }
+      });
+    }
+
+    std::uint32_t
+    add_host(const VirtualHost * host)
+    {
+      return add(m_hosts, m_result.m_hosts, host, [&](ResolvedSession::Host& item) {
+        item.m_uid = host->UID();
+        item.m_physical_host = host->get_runs_on()->UID();
+      });
+    }
+
+    std::uint32_t
+    add_service(const Service * service)
+    {
+      return add(m_services, m_result.m_services, service, [&](ResolvedSession::Service& item) {
+        item.m_uid = service->UID();
+        item.m_protocol = service->get_protocol();
+        item.m_port = service->get_port();
+        item.m_eth_device_name = service->get_eth_device_name();
+        item.m_path = service->get_path();
+      });
+    }
+
+    std::uint32_t
+    add_module(const DaqModule * mod)
+    {
+      return add(m_modules, m_result.m_modules, mod, [&](ResolvedSession::Module& item) {
+        item.m_uid = mod->UID();
+        item.m_class = mod->class_name();
+        item.m_enabled = enabled(mod->cast<Component>());
+        for (auto c : mod->get_inputs()) {
+          item.m_inputs.push_back(add_connection(c));
+        }
+        for (auto c : mod->get_outputs()) {
+          item.m_outputs.push_back(add_connection(c));
+        }
+      });
+    }
+
+    std::uint32_t
+    add_connection(const Connection * c)
+    {
+      return add(m_connections, m_result.m_connections, c, [&](ResolvedSession::Connection& item) {
+        item.m_uid = c->UID();
+        item.m_class = c->class_name();
+        item.m_data_type = c->get_data_type();
+        auto nc = c->cast<NetworkConnection>();
+        item.m_service = (nc ? add_service(nc->get_associated_service()) : ResolvedSession::npos);
+      });
+    }
+
+      // detector to DAQ connections contained by the resource set at any level; a set shared by
+      // several applications is visited once
+
+    void
+    add_readout_map(const ResourceSet * set)
+    {
+      if (!m_visited_sets.insert(set).second) {
+        return;
+      }
+
+      for (auto res : set->get_contains()) {
+        if (auto d2d = res->cast<DetectorToDaqConnection>()) {
+          add_readout_connection(d2d);
+        }
+        else if (auto rs = res->cast<ResourceSet>()) {
+          add_readout_map(rs);
+        }
+      }
+    }
+
+    void
+    add_readout_connection(const DetectorToDaqConnection * d2d)
+    {
+      add(m_readout_connections, m_result.m_readout_connections, d2d, [&](ResolvedSession::ReadoutConnection& item) {
+        item.m_uid = d2d->UID();
+        item.m_enabled = enabled(d2d);
+        auto receiver = d2d->get_receiver();
+        item.m_receiver = receiver->UID();
+        item.m_receiver_class = receiver->class_name();
+        item.m_receiver_enabled = enabled(receiver);
+        for (auto sender : d2d->get_senders()) {
+          item.m_senders.push_back(add_sender(sender));
+        }
+      });
+    }
+
+    std::uint32_t
+    add_sender(const DetDataSender * sender)
+    {
+      return add(m_senders, m_result.m_senders, sender, [&](ResolvedSession::Sender& item) {
+        item.m_uid = sender->UID();
+        item.m_class = sender->class_name();
+        item.m_enabled = enabled(sender);
+        for (auto res : sender->get_contains()) {
+          auto stream = res->cast<DetectorStream>();
+          if (stream == nullptr) {
+            throw ConfigurationError(ERS_HERE, "DetDataSender '" + sender->UID() + "' contains non-stream object '" + res->UID() + "'");
+          }
+          item.m_streams.push_back(add_stream(stream));
+        }
+      });
+    }
+
+    std::uint32_t
+    add_stream(const DetectorStream * stream)
+    {
+      return add(m_streams, m_result.m_streams, stream, [&](ResolvedSession::Stream& item) {
+        const GeoId * geo_id = stream->get_geo_id();
+        item.m_uid = stream->UID();
+        item.m_source_id = stream->get_source_id();
+        item.m_detector_id = geo_id->get_detector_id();
+        item.m_crate_id = geo_id->get_crate_id();
+        item.m_slot_id = geo_id->get_slot_id();
+        item.m_stream_id = geo_id->get_stream_id();
+        item.m_enabled = enabled(stream);
+      });
+    }
+
+    const dunedaq::conffwk::Configuration& m_db;
+    const Session& m_session;
+    ResolvedSession m_result;
+
+    std::unordered_set<const Application *> m_enabled_applications;
+    std::unordered_set<const ResourceSet *> m_visited_sets;
+
+    std::unordered_map<const Segment *, std::uint32_t> m_segments;
+    std::unordered_map<const Application *, std::uint32_t> m_applications;
+    std::unordered_map<const VirtualHost *, std::uint32_t> m_hosts;
+    std::unordered_map<const Service *, std::uint32_t> m_services;
+    std::unordered_map<const DaqModule *, std::uint32_t> m_modules;
+    std::unordered_map<const Connection *, std::uint32_t> m_connections;
+    std::unordered_map<const DetectorToDaqConnection *, std::uint32_t> m_readout_connections;
+    std::unordered_map<const DetDataSender *, std::uint32_t> m_senders;
+    std::unordered_map<const DetectorStream *, std::uint32_t> m_streams;
+  };
+
+
+    // the class names are stored once in the "classes" table and referenced by index
+
+  class Encoder
+  {
+
+  public:
+
+    nlohmann::json
+    encode(const ResolvedSession& s)
+    {
+      nlohmann::json result = {
+        {"format", format_name},
+        {"version", ResolvedSession::format_version},
+        {"schema", s.m_schema_version},
+        {"source", s.m_source},
+        {"uid", s.m_uid},
+        {"segment", s.m_segment}
+      };
+
+      result["services"] = table(s.m_services, [](const ResolvedSession::Service& x) {
+        return nlohmann::json::array({x.m_uid, x.m_protocol, x.m_port, x.m_eth_device_name, x.m_path});
+      });
+
+      result["hosts"] = table(s.m_hosts, [](const ResolvedSession::Host& x) {
+        return nlohmann::json::array({x.m_uid, x.m_physical_host});
+      });
+
+      result["connections"] = table(s.m_connections, [this](const ResolvedSession::Connection& x) {
+        return nlohmann::json::array({x.m_uid, class_id(x.m_class), x.m_data_type, x.m_service});
+      });
+
+      result["modules"] = table(s.m_modules, [this](const ResolvedSession::Module& x) {
+        return nlohmann::json::array({x.m_uid, class_id(x.m_class), x.m_enabled, x.m_inputs, x.m_outputs});
+      });
+
+      result["applications"] = table(s.m_applications, [this](const ResolvedSession::Application& x) {
+        return nlohmann::json::array({x.m_uid, class_id(x.m_class), x.m_application_name, x.m_commandline_parameters,
+                                      x.m_enabled, x.m_host, x.m_services, x.m_modules});
+      });
+
+      result["segments"] = table(s.m_segments, [](const ResolvedSession::Segment& x) {
+        return nlohmann::json::array({x.m_uid, x.m_enabled, x.m_controller, x.m_segments, x.m_applications});
+      });
+
+      result["streams"] = table(s.m_streams, [](const ResolvedSession::Stream& x) {
+        return nlohmann::json::array({x.m_uid, x.m_source_id, x.m_detector_id, x.m_crate_id, x.m_slot_id, x.m_stream_id, x.m_enabled});
+      });
+
+      result["senders"] = table(s.m_senders, [this](const ResolvedSession::Sender& x) {
+        return nlohmann::json::array({x.m_uid, class_id(x.m_class), x.m_enabled, x.m_streams});
+      });
+
+      result["readout_connections"] = table(s.m_readout_connections, [this](const ResolvedSession::ReadoutConnection& x) {
+        return nlohmann::json::array({x.m_uid, x.m_enabled, x.m_receiver, class_id(x.m_receiver_class), x.m_receiver_enabled, x.m_senders});
+      });
+
+      result["classes"] = std::move(m_classes);
+
+      return result;
+    }
+
+  private:
+
+    template<class T, class F>
+    static nlohmann::json
+    table(const std::vector<T>& items, F encode)
+    {
+      nlohmann::json result = nlohmann::json::array();
+      for (const auto& x : items) {
+        result.push_back(encode(x));
+      }
+      return result;
+    }
+
+    std::uint32_t
+    class_id(const std::string& name)
+    {
+      auto it = m_class_ids.emplace(name, m_class_ids.size());
+      if (it.second) {
+        m_classes.push_back(name);
+      }
+      return it.first->second;
+    }
+
+    std::unordered_map<std::string, std::uint32_t> m_class_ids;
+    nlohmann::json m_classes = nlohmann::json::array();
+  };
+
+
+  class Decoder
+  {
+
+  public:
+
+    ResolvedSession
+    decode(const nlohmann::json& data)
+    {
+      if (!data.is_object() || data.value("format", std::string()) != format_name) {
+        throw std::runtime_error("not a resolved session");
+      }
+
+      const auto version = data.at("version").get<std::uint32_t>();
+      if (version != ResolvedSession::format_version) {
+        throw std::runtime_error("unsupported format version " + std::to_string(version) +
+                                 " (expected " + std::to_string(ResolvedSession::format_version) + ")");
+      }
+
+      ResolvedSession s;
+      data.at("schema").get_to(s.m_schema_version);
+      if (s.m_schema_version != ResolvedSession::get_schema_version()) {
+        throw std::runtime_error("resolved with schema version " + s.m_schema_version +
+                                 " (expected " + ResolvedSession::get_schema_version() + ")");
+      }
+
+      data.at("classes").get_to(m_classes);
+
+      data.at("source").get_to(s.m_source);
+      data.at("uid").get_to(s.m_uid);
+      data.at("segment").get_to(s.m_segment);
+
+      table(data, "services", s.m_services, [](Fields& f, ResolvedSession::Service& x) {
+        f >> x.m_uid >> x.m_protocol >> x.m_port >> x.m_eth_device_name >> x.m_path;
+      });
+
+      table(data, "hosts", s.m_hosts, [](Fields& f, ResolvedSession::Host& x) {
+        f >> x.m_uid >> x.m_physical_host;
+      });
+
+      table(data, "connections", s.m_connections, [](Fields& f, ResolvedSession::Connection& x) {
+        f >> x.m_uid; f.class_name(x.m_class); f >> x.m_data_type >> x.m_service;
+      });
+
+      table(data, "modules", s.m_modules, [](Fields& f, ResolvedSession::Module& x) {
+        f >> x.m_uid; f.class_name(x.m_class); f >> x.m_enabled >> x.m_inputs >> x.m_outputs;
+      });
+
+      table(data, "applications", s.m_applications, [](Fields& f, ResolvedSession::Application& x) {
+        f >> x.m_uid; f.class_name(x.m_class);
+        f >> x.m_application_name >> x.m_commandline_parameters >> x.m_enabled >> x.m_host >> x.m_services >> x.m_modules;
+      });
+
+      table(data, "segments", s.m_segments, [](Fields& f, ResolvedSession::Segment& x) {
+        f >> x.m_uid >> x.m_enabled >> x.m_controller >> x.m_segments >> x.m_applications;
+      });
+
+      table(data, "streams", s.m_streams, [](Fields& f, ResolvedSession::Stream& x) {
+        f >> x.m_uid >> x.m_source_id >> x.m_detector_id >> x.m_crate_id >> x.m_slot_id >> x.m_stream_id >> x.m_enabled;
+      });
+
+      table(data, "senders", s.m_senders, [](Fields& f, ResolvedSession::Sender& x) {
+        f >> x.m_uid; f.class_name(x.m_class); f >> x.m_enabled >> x.m_streams;
+      });
+
+      table(data, "readout_connections", s.m_readout_connections, [](Fields& f, ResolvedSession::ReadoutConnection& x) {
+        f >> x.m_uid >> x.m_enabled >> x.m_receiver; f.class_name(x.m_receiver_class); f >> x.m_receiver_enabled >> x.m_senders;
+      });
+
+      check(s);
+
+      return s;
+    }
+
+  private:
+
+      // the fields of an object in order of the array elements
+
+    class Fields
+    {
+
+    public:
+
+      Fields(const nlohmann::json& item, const std::vector<std::string>& classes) :
+        m_item(item),
+        m_classes(classes)
+      {
+        if (!m_item.is_array()) {
+          throw std::runtime_error("an object is not an array");
+        }
+      }
+
+      template<class T>
+      Fields&
+      operator>>(T& value)
+      {
+        m_item.at(m_next++).get_to(value);
+        return *this;
+      }
+
+      void
+      class_name(std::string& value)
+      {
+        value = m_classes.at(m_item.at(m_next++).get<std::uint32_t>());
+      }
+
+    private:
+
+      const nlohmann::json& m_item;
+      const std::vector<std::string>& m_classes;
+      std::size_t m_next = 0;
+    };
+
+    template<class T, class F>
+    void
+    table(const nlohmann::json& data, const char * name, std::vector<T>& items, F decode) const
+    {
+      const nlohmann::json& t = data.at(name);
+      items.resize(t.size());
+      for (std::size_t i = 0; i < items.size(); ++i) {
+        Fields f(t.at(i), m_classes);
+        decode(f, items[i]);
+      }
+    }
+
+      // every index refers to an object of the table; a corrupted file must not cause out of range access
+
+    static void
+    check(std::uint32_t idx, std::size_t size, bool optional, const char * table)
+    {
+      if (idx >= size && !(optional && idx == ResolvedSession::npos)) {
+        throw std::runtime_error("bad index " + std::to_string(idx) + " of " + table + " table");
+      }
+    }
+
+    static void
+    check(const std::vector<std::uint32_t>& v, std::size_t size, const char * table)
+    {
+      for (auto idx : v) {
+        check(idx, size, false, table);
+      }
+    }
+
+    static void
+    check(const ResolvedSession& s)
+    {
+      check(s.m_segment, s.m_segments.size(), true, "segments");
+
+      for (const auto& x : s.m_connections) {
+        check(x.m_service, s.m_services.size(), true, "services");
+      }
+
+      for (const auto& x : s.m_modules) {
+        check(x.m_inputs, s.m_connections.size(), "connections");
+        check(x.m_outputs, s.m_connections.size(), "connections");
+      }
+
+      for (const auto& x : s.m_applications) {
+        check(x.m_host, s.m_hosts.size(), true, "hosts");
+        check(x.m_services, s.m_services.size(), "services");
+        check(x.m_modules, s.m_modules.size(), "modules");
+      }
+
+      for (const auto& x : s.m_segments) {
+        check(x.m_controller, s.m_applications.size(), true, "applications");
+        check(x.m_segments, s.m_segments.size(), "segments");
+        check(x.m_applications, s.m_applications.size(), "applications");
+      }
+
+      for (const auto& x : s.m_senders) {
+        check(x.m_streams, s.m_streams.size(), "streams");
+      }
+
+      for (const auto& x : s.m_readout_connections) {
+        check(x.m_senders, s.m_senders.size(), "senders");
+      }
+    }
+
+    std::vector<std::string> m_classes;
+  };
+
+} // namespace
+
+
+namespace dunedaq::confmodel {
+
+std::string
+ResolvedSession::get_schema_version()
+{
+  return CONFMODEL_SCHEMA_VERSION;
+}
+
+ResolvedSession
+resolve_session(const dunedaq::conffwk::Configuration& db, const Session& session)
+{
+  return Resolver(db, session).run();
+}
+
+void
+write_resolved_session(const ResolvedSession& session, std::ostream& out)
+{
+  nlohmann::json::to_cbor(Encoder().encode(session), out);
+
+  if (!out) {
+    throw BadResolvedSession(ERS_HERE, session.m_uid, "failed to write output stream");
+  }
+}
+
+ResolvedSession
+read_resolved_session(std::istream& in)
+{
+  try {
+    return Decoder().decode(nlohmann::json::from_cbor(in));
+  }
+  catch (const std::exception& ex) {
+    throw BadResolvedSession(ERS_HERE, "input stream", ex.what());
+  }
+}
+
+void
+write_resolved_session(const ResolvedSession& session, const std::string& file)
+{
+  std::ofstream out(file, std::ios::binary);
+
+  if (!out) {
+    throw BadResolvedSession(ERS_HERE, file, "cannot open file for writing");
+  }
+
+  write_resolved_session(session, out);
+}
+
+ResolvedSession
+read_resolved_session(const std::string& file)
+{
+  std::ifstream in(file, std::ios::binary);
+
+  if (!in) {
+    throw BadResolvedSession(ERS_HERE, file, "cannot open file");
+  }
+
+  try {
+    return Decoder().decode(nlohmann::json::from_cbor(in));
+  }
+  catch (const std::exception& ex) {
+    throw BadResolvedSession(ERS_HERE, file, ex.what());
+  }
+}
+
+} // namespace dunedaq::confmodel
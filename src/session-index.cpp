@@ -0,0 +1,532 @@
+#include "confmodel/session-index.hpp"
+
+#include "confmodel/Application.hpp"
+#include "confmodel/Component.hpp"
+#include "confmodel/DetDataReceiver.hpp"
+#include "confmodel/DetDataSender.hpp"
+#include "confmodel/DetectorStream.hpp"
+#include "confmodel/DetectorToDaqConnection.hpp"
+#include "confmodel/GeoId.hpp"
+#include "confmodel/RCApplication.hpp"
+#include "confmodel/ResourceBase.hpp"
+#include "confmodel/ResourceSet.hpp"
+#include "confmodel/Segment.hpp"
+#include "confmodel/Session.hpp"
+#include "confmodel/util.hpp"
+
+#include "conffwk/ConfigObject.hpp"
+#include "conffwk/Configuration.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace dunedaq::conffwk;
+
+namespace {
+
+  const char magic[8] = {'c', 'm', 'i', 'n', 'd', 'e', 'x', '\0'};
+  const std::uint32_t byte_order = 0x01020304;
+
+    // FNV-1a
+
+  std::uint64_t
+  hash(const char * data, std::size_t size, std::uint64_t h = 14695981039346656037ULL)
+  {
+    for (std::size_t i = 0; i < size; ++i) {
+      h = (h ^ static_cast<unsigned char>(data[i])) * 1099511628211ULL;
+    }
+    return h;
+  }
+
+    // names and contents of the data files; a missing file changes the hash as any modification does
+
+  std::uint64_t
+  hash_files(const std::vector<std::string>& files)
+  {
+    std::uint64_t h = hash(nullptr, 0);
+    std::vector<char> buf(1 << 16);
+
+    for (const auto& name : files) {
+      h = hash(name.c_str(), name.size() + 1, h);
+      std::ifstream in(name, std::ios::binary);
+      while (in) {
+        in.read(buf.data(), buf.size());
+        h = hash(buf.data(), in.gcount(), h);
+      }
+      h = hash(in.eof() ? "+" : "-", 1, h);
+    }
+
+    return h;
+  }
+
+} // namespace
+
+
+namespace dunedaq::confmodel {
+
+class SessionIndexBuilder
+{
+
+public:
+
+  SessionIndexBuilder(Configuration& db, const Session& session) :
+    m_session(session)
+  {
+    for (auto app : session.get_enabled_applications()) {
+      m_enabled_applications.insert(app);
+    }
+
+    m_spec = intern(db.get_impl_spec());
+    m_session_uid = intern(session.UID());
+    m_files.insert(session.config_object().contained_in());
+
+    add_segment(session.get_segment(), true);
+
+    for (auto app : session.get_infrastructure_applications()) {
+      auto c = app->cast<Component>();
+      add_application(app, c == nullptr || !c->disabled(session));
+    }
+  }
+
+  void
+  write(const std::string& file)
+  {
+    std::string data(sizeof(SessionIndex::Header), '\0');
+    SessionIndex::Header header;
+    std::memset(&header, 0, sizeof(header));
+
+    auto add = [&](SessionIndex::Table t, const auto& v) {
+      data.resize((data.size() + 7) & ~static_cast<std::size_t>(7), '\0');
+      header.m_tables[t].m_offset = data.size();
+      header.m_tables[t].m_count = v.size();
+      data.append(reinterpret_cast<const char *>(v.data()), v.size() * sizeof(v[0]));
+    };
+
+    std::vector<std::uint32_t> file_ids;
+    for (const auto& f : m_files) {
+      file_ids.push_back(intern(f));
+    }
+
+    std::vector<std::uint32_t> sorted(m_items.size());
+    for (std::uint32_t i = 0; i < sorted.size(); ++i) {
+      sorted[i] = i;
+    }
+    std::sort(sorted.begin(), sorted.end(), [this](std::uint32_t a, std::uint32_t b) {
+      return m_strings[m_items[a].m_uid] < m_strings[m_items[b].m_uid];
+    });
+
+    std::stable_sort(m_streams.begin(), m_streams.end(), [](const SessionIndex::Stream& a, const SessionIndex::Stream& b) {
+      return a.m_source_id < b.m_source_id;
+    });
+
+    std::vector<std::uint32_t> string_offsets(1, 0);
+    std::string string_data;
+    for (const auto& s : m_strings) {
+      string_data.append(s);
+      string_offsets.push_back(string_data.size());
+    }
+
+    add(SessionIndex::string_offsets, string_offsets);
+    add(SessionIndex::string_data, string_data);
+    add(SessionIndex::items, m_items);
+    add(SessionIndex::sorted_items, sorted);
+    add_csr(add, SessionIndex::contains_offsets, SessionIndex::contains_targets, m_contains, m_items.size());
+    add_csr(add, SessionIndex::segments_offsets, SessionIndex::segments_targets, m_segments, m_items.size());
+    add_csr(add, SessionIndex::applications_offsets, SessionIndex::applications_targets, m_applications, m_items.size());
+    add(SessionIndex::streams, m_streams);
+    add(SessionIndex::readout_connections, m_readout_connections);
+    add_csr(add, SessionIndex::senders_offsets, SessionIndex::senders_targets, m_senders, m_readout_connections.size());
+    add(SessionIndex::files, file_ids);
+
+    std::memcpy(header.m_magic, magic, sizeof(magic));
+    header.m_version = SessionIndex::format_version;
+    header.m_byte_order = byte_order;
+    header.m_size = data.size();
+    header.m_content_hash = hash(data.data() + sizeof(header), data.size() - sizeof(header));
+    header.m_source_hash = hash_files(std::vector<std::string>(m_files.begin(), m_files.end()));
+    header.m_spec = m_spec;
+    header.m_session = m_session_uid;
+    std::memcpy(&data[0], &header, sizeof(header));
+
+    // processes may have the file mapped: write a new file and replace the old one; the name of the new
+    // file is unique, so processes rebuilding the same index do not write into the same file
+
+    std::string tmp = file + ".XXXXXX";
+
+    const int fd = ::mkstemp(&tmp[0]);
+
+    if (fd == -1) {
+      throw BadSessionIndex(ERS_HERE, file, std::string("failed to create temporary file: ") + std::strerror(errno));
+    }
+
+    auto fail = [&](const std::string& what, const std::string& name) {
+      const std::string reason = what + ": " + std::strerror(errno);
+      ::close(fd);
+      ::unlink(tmp.c_str());
+      throw BadSessionIndex(ERS_HERE, name, reason);
+    };
+
+    // mkstemp() creates the file readable by the owner only
+    if (::fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) != 0) {
+      fail("failed to set mode", tmp);
+    }
+
+    for (std::size_t pos = 0; pos < data.size();) {
+      const ssize_t len = ::write(fd, data.data() + pos, data.size() - pos);
+      if (len < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        fail("failed to write file", tmp);
+      }
+      pos += len;
+    }
+
+    // the contents reach the disk before the new file replaces the old one, so after a crash readers do not
+    // map a file with the right name and incomplete contents
+    if (::fsync(fd) != 0) {
+      fail("failed to sync file", tmp);
+    }
+
+    if (::rename(tmp.c_str(), file.c_str()) != 0) {
+      fail("failed to rename " + tmp, file);
+    }
+
+    ::close(fd);
+  }
+
+private:
+
+  template<class F>
+  static void
+  add_csr(F& add, SessionIndex::Table offsets_table, SessionIndex::Table targets_table,
+          const std::unordered_map<std::uint32_t, std::vector<std::uint32_t>>& adjacency, std::size_t size)
+  {
+    std::vector<std::uint32_t> offsets(1, 0);
+    std::vector<std::uint32_t> targets;
+    offsets.reserve(size + 1);
+
+    for (std::uint32_t i = 0; i < size; ++i) {
+      auto it = adjacency.find(i);
+      if (it != adjacency.end()) {
+        targets.insert(targets.end(), it->second.begin(), it->second.end());
+      }
+      offsets.push_back(targets.size());
+    }
+
+    add(offsets_table, offsets);
+    add(targets_table, targets);
+  }
+
+  std::uint32_t
+  intern(const std::string& s)
+  {
+    auto it = m_string_ids.emplace(s, m_strings.size());
+    if (it.second) {
+      m_strings.push_back(s);
+    }
+    return it.first->second;
+  }
+
+    // the ID of the object; new object is appended and false is returned to fill its relationships
+
+  template<class T>
+  std::pair<std::uint32_t, bool>
+  add_item(const T * obj, SessionIndex::Kind kind, bool enabled)
+  {
+    auto it = m_index.emplace(obj->config_object().implementation(), m_items.size());
+
+    if (it.second) {
+      m_items.push_back({intern(obj->UID()), intern(obj->class_name()), kind, enabled, 0});
+      m_files.insert(obj->config_object().contained_in());
+    }
+
+    return {it.first->second, !it.second};
+  }
+
+  std::uint32_t
+  add_segment(const Segment * seg, bool parent_enabled)
+  {
+    const bool enabled = parent_enabled && !seg->disabled(m_session);
+    auto id = add_item(seg, SessionIndex::segment, enabled);
+
+    if (id.second) {
+      return id.first;
+    }
+
+    auto& apps = m_applications[id.first];
+    apps.push_back(add_application(seg->get_controller(), enabled));
+    for (auto app : seg->get_applications()) {
+      apps.push_back(add_application(app, m_enabled_applications.count(app) != 0));
+    }
+
+    for (auto s : seg->get_segments()) {
+      m_segments[id.first].push_back(add_segment(s, enabled));
+    }
+
+    return id.first;
+  }
+
+  std::uint32_t
+  add_application(const Application * app, bool enabled)
+  {
+    auto id = add_item(app, SessionIndex::application, enabled);
+
+    if (!id.second) {
+      if (auto rs = app->cast<ResourceSet>()) {
+        add_contains(id.first, rs);
+      }
+    }
+
+    return id.first;
+  }
+
+  std::uint32_t
+  add_resource(const ResourceBase * res)
+  {
+    auto rs = res->cast<ResourceSet>();
+    auto id = add_item(res, rs ? SessionIndex::resource_set : SessionIndex::resource, !res->disabled(m_session));
+
+    if (id.second) {
+      return id.first;
+    }
+
+    if (rs) {
+      add_contains(id.first, rs);
+    }
+
+    if (auto d2d = res->cast<DetectorToDaqConnection>()) {
+      const std::uint32_t idx = m_readout_connections.size();
+      m_readout_connections.push_back({id.first, add_resource(d2d->get_receiver())});
+      for (auto sender : d2d->get_senders()) {
+        m_senders[idx].push_back(add_resource(sender));
+      }
+    }
+    else if (auto stream = res->cast<DetectorStream>()) {
+      // the geo ID is not an item, but its attributes are copied: its file is one of the sources of the index
+      auto geo_id = stream->get_geo_id();
+      m_files.insert(geo_id->config_object().contained_in());
+      m_streams.push_back({id.first, stream->get_source_id(), geo_id->get_detector_id(), geo_id->get_crate_id(),
+                           geo_id->get_slot_id(), geo_id->get_stream_id()});
+    }
+
+    return id.first;
+  }
+
+  void
+  add_contains(std::uint32_t id, const ResourceSet * rs)
+  {
+    std::vector<std::uint32_t> contains;
+    for (auto res : rs->get_contains()) {
+      contains.push_back(add_resource(res));
+    }
+    m_contains[id] = std::move(contains);
+  }
+
+  const Session& m_session;
+  std::unordered_set<const Application *> m_enabled_applications;
+
+  std::unordered_map<const ConfigObjectImpl *, std::uint32_t> m_index;
+  std::vector<SessionIndex::Item> m_items;
+  std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> m_contains;
+  std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> m_segments;
+  std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> m_applications;
+  std::vector<SessionIndex::Stream> m_streams;
+  std::vector<SessionIndex::ReadoutConnection> m_readout_connections;
+  std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> m_senders;
+
+  std::unordered_map<std::string, std::uint32_t> m_string_ids;
+  std::vector<std::string> m_strings;
+  std::uint32_t m_spec;
+  std::uint32_t m_session_uid;
+  std::set<std::string> m_files;
+};
+
+
+void
+SessionIndex::write(Configuration& db, const Session& session, const std::string& file)
+{
+  SessionIndexBuilder(db, session).write(file);
+}
+
+SessionIndex::SessionIndex(const std::string& file, bool verify) :
+  m_data(nullptr),
+  m_size(0)
+{
+  int fd = ::open(file.c_str(), O_RDONLY);
+
+  if (fd < 0) {
+    throw BadSessionIndex(ERS_HERE, file, std::strerror(errno));
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+    ::close(fd);
+    throw BadSessionIndex(ERS_HERE, file, "file is too short");
+  }
+
+  m_size = st.st_size;
+  m_data = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+
+  if (m_data == MAP_FAILED) {
+    throw BadSessionIndex(ERS_HERE, file, std::string("mmap failed: ") + std::strerror(errno));
+  }
+
+  try {
+    check(verify);
+  }
+  catch (const std::exception& ex) {
+    ::munmap(m_data, m_size);
+    throw BadSessionIndex(ERS_HERE, file, ex.what());
+  }
+}
+
+SessionIndex::~SessionIndex()
+{
+  ::munmap(m_data, m_size);
+}
+
+  // the layout of tables, ascending offsets and all stored IDs are always checked, so the accessors never read
+  // outside the mapped file for IDs returned by the index; these checks are linear in the number of items and
+  // relationships and read the tables, but not the strings; the hash of the whole contents is only checked
+  // on request, as it reads every page of the file
+
+void
+SessionIndex::check(bool verify) const
+{
+  const Header& h = header();
+
+  if (std::memcmp(h.m_magic, magic, sizeof(magic)) != 0) {
+    throw std::runtime_error("not a session index");
+  }
+
+  if (h.m_version != format_version || h.m_byte_order != byte_order) {
+    throw std::runtime_error("unsupported format version " + std::to_string(h.m_version) + " or byte order");
+  }
+
+  if (h.m_size != m_size) {
+    throw std::runtime_error("file size " + std::to_string(m_size) + " differs from expected " + std::to_string(h.m_size));
+  }
+
+  const std::size_t element_size[num_of_tables] = {
+    sizeof(std::uint32_t), sizeof(char), sizeof(Item), sizeof(std::uint32_t),
+    sizeof(std::uint32_t), sizeof(std::uint32_t), sizeof(std::uint32_t), sizeof(std::uint32_t),
+    sizeof(std::uint32_t), sizeof(std::uint32_t),
+    sizeof(Stream), sizeof(ReadoutConnection), sizeof(std::uint32_t), sizeof(std::uint32_t),
+    sizeof(std::uint32_t)
+  };
+
+  for (unsigned int t = 0; t < num_of_tables; ++t) {
+    const auto& x = h.m_tables[t];
+    if (x.m_offset < sizeof(Header) || x.m_offset % 8 || x.m_offset > m_size || x.m_count > (m_size - x.m_offset) / element_size[t]) {
+      throw std::runtime_error("bad layout of table " + std::to_string(t));
+    }
+  }
+
+  if (verify && hash(static_cast<const char *>(m_data) + sizeof(Header), m_size - sizeof(Header)) != h.m_content_hash) {
+    throw std::runtime_error("content hash mismatch");
+  }
+
+  // size + 1 ascending offsets from 0 to the number of targets
+  const auto offsets_ok = [this](Table offsets, Table targets, std::size_t size) {
+    const auto o = get<std::uint32_t>(offsets);
+    return (o.size() == size + 1 && o[0] == 0 && o[size] == get<std::uint32_t>(targets).size() && std::is_sorted(o.begin(), o.end()));
+  };
+
+  auto below = [this](Table t, std::size_t size) {
+    const auto v = get<std::uint32_t>(t);
+    return std::all_of(v.begin(), v.end(), [size](std::uint32_t x) { return x < size; });
+  };
+
+  if (h.m_tables[string_offsets].m_count == 0) {
+    throw std::runtime_error("no string offsets");
+  }
+
+  const std::size_t num_of_items = h.m_tables[items].m_count;
+  const std::size_t num_of_strings = h.m_tables[string_offsets].m_count - 1;
+
+  if (!offsets_ok(string_offsets, string_data, num_of_strings) ||
+      h.m_tables[sorted_items].m_count != num_of_items ||
+      !offsets_ok(contains_offsets, contains_targets, num_of_items) ||
+      !offsets_ok(segments_offsets, segments_targets, num_of_items) ||
+      !offsets_ok(applications_offsets, applications_targets, num_of_items) ||
+      !offsets_ok(senders_offsets, senders_targets, h.m_tables[readout_connections].m_count) ||
+      h.m_spec >= num_of_strings || h.m_session >= num_of_strings) {
+    throw std::runtime_error("inconsistent tables");
+  }
+
+  bool ok = below(sorted_items, num_of_items) && below(contains_targets, num_of_items) &&
+            below(segments_targets, num_of_items) && below(applications_targets, num_of_items) &&
+            below(senders_targets, num_of_items) && below(files, num_of_strings);
+
+  for (const auto& x : get<Item>(items)) {
+    ok = ok && x.m_uid < num_of_strings && x.m_class < num_of_strings;
+  }
+
+  for (const auto& x : get<Stream>(streams)) {
+    ok = ok && x.m_item < num_of_items;
+  }
+
+  for (const auto& x : get<ReadoutConnection>(readout_connections)) {
+    ok = ok && x.m_item < num_of_items && x.m_receiver < num_of_items;
+  }
+
+  if (!ok) {
+    throw std::runtime_error("bad item or string ID");
+  }
+}
+
+bool
+SessionIndex::is_valid(const std::string& spec) const
+{
+  if (get_spec() != spec) {
+    return false;
+  }
+
+  std::vector<std::string> names;
+  for (auto id : get<std::uint32_t>(files)) {
+    names.emplace_back(get_string(id));
+  }
+
+  return (hash_files(names) == header().m_source_hash);
+}
+
+std::uint32_t
+SessionIndex::find(std::string_view uid) const
+{
+  const auto sorted = get<std::uint32_t>(sorted_items);
+
+  auto it = std::lower_bound(sorted.begin(), sorted.end(), uid, [this](std::uint32_t id, std::string_view value) {
+    return get_uid(id) < value;
+  });
+
+  return (it != sorted.end() && get_uid(*it) == uid) ? *it : npos;
+}
+
+const SessionIndex::Stream *
+SessionIndex::find_stream(std::uint32_t source_id) const
+{
+  const auto v = get<Stream>(streams);
+
+  auto it = std::lower_bound(v.begin(), v.end(), source_id, [](const Stream& x, std::uint32_t value) {
+    return x.m_source_id < value;
+  });
+
+  return (it != v.end() && it->m_source_id == source_id) ? it : nullptr;
+}
+
+} // namespace dunedaq::confmodel
@@ -0,0 +1,210 @@
+/**
+ * @file util.cpp
+ *
+ * Implementations of confmodel algorithms declared in util.hpp
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "confmodel/util.hpp"
+
+#include "confmodel/Application.hpp"
+#include "confmodel/DaqApplication.hpp"
+#include "confmodel/DaqModule.hpp"
+#include "confmodel/PhysicalHost.hpp"
+#include "confmodel/RCApplication.hpp"
+#include "confmodel/ResourceBase.hpp"
+#include "confmodel/ResourceSet.hpp"
+#include "confmodel/Segment.hpp"
+#include "confmodel/Service.hpp"
+#include "confmodel/Session.hpp"
+#include "confmodel/VirtualHost.hpp"
+
+#include "conffwk/Schema.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <cstdlib>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace dunedaq::conffwk;
+
+namespace {
+
+    // instantiate and initialize DAL objects of the session layer by layer, so the later DAL calls find
+    // them in the cache; objects referenced by the session are not expanded, if their classes are not in rclasses
+
+  class Prefetch
+  {
+
+  public:
+
+    Prefetch(Configuration& conf, const std::vector<std::string> * rclasses) :
+      m_conf(conf)
+    {
+      if (rclasses) {
+        m_rclasses = std::unordered_set<std::string>(rclasses->begin(), rclasses->end());
+        m_restricted = true;
+      }
+    }
+
+    void
+    run(const dunedaq::confmodel::Session& session, unsigned long rlevel)
+    {
+      std::vector<const DalObject *> layer;
+      add(&session, layer);
+
+      for (unsigned long level = 0; level < rlevel && !layer.empty(); ++level) {
+        std::vector<const DalObject *> next;
+        for (auto obj : layer) {
+          if (level == 0 || is_expanded(obj->class_name())) {
+            expand(*obj, next);
+          }
+        }
+        layer.swap(next);
+      }
+
+      TLOG_DEBUG(3) << "prefetched " << m_visited.size() << " objects of session " << session.UID();
+    }
+
+  private:
+
+    template<class T>
+    void
+    add(const T * obj, std::vector<const DalObject *>& next)
+    {
+      if (obj && m_visited.insert(obj->config_object().implementation()).second) {
+        next.push_back(obj);
+      }
+    }
+
+    template<class T>
+    void
+    add(const std::vector<const T *>& objs, std::vector<const DalObject *>& next)
+    {
+      for (auto obj : objs) {
+        add(obj, next);
+      }
+    }
+
+    void
+    expand(const DalObject& obj, std::vector<const DalObject *>& next)
+    {
+      using namespace dunedaq::confmodel;
+
+      if (auto session = obj.cast<Session>()) {
+        add(session->get_segment(), next);
+        add(session->get_infrastructure_applications(), next);
+        add(session->get_disabled(), next);
+      }
+
+      if (auto seg = obj.cast<Segment>()) {
+        add(seg->get_controller(), next);
+        add(seg->get_applications(), next);
+        add(seg->get_segments(), next);
+      }
+
+      if (auto app = obj.cast<Application>()) {
+        add(app->get_runs_on(), next);
+        add(app->get_exposes_service(), next);
+      }
+
+      if (auto daq_app = obj.cast<DaqApplication>()) {
+        add(daq_app->get_modules(), next);
+      }
+
+      if (auto rs = obj.cast<ResourceSet>()) {
+        add(rs->get_contains(), next);
+      }
+    }
+
+    bool
+    is_expanded(const std::string& class_name)
+    {
+      if (!m_restricted) {
+        return true;
+      }
+
+      auto it = m_expanded.find(class_name);
+
+      if (it == m_expanded.end()) {
+        bool found = m_rclasses.count(class_name) != 0;
+        for (const auto& c : m_conf.get_class_info(class_name).p_superclasses) {
+          found = found || m_rclasses.count(c) != 0;
+        }
+        it = m_expanded.emplace(class_name, found).first;
+      }
+
+      return it->second;
+    }
+
+    Configuration& m_conf;
+    bool m_restricted = false;
+    std::unordered_set<std::string> m_rclasses;
+    std::unordered_map<std::string, bool> m_expanded;
+    std::unordered_set<const ConfigObjectImpl *> m_visited;
+  };
+
+} // namespace
+
+
+const dunedaq::confmodel::Session *
+dunedaq::confmodel::get_session(Configuration& conf, const std::string& name, unsigned long rlevel, const std::vector<std::string> * rclasses)
+{
+  std::string session_name(name);
+
+  if (session_name.empty()) {
+    if (const char * s = std::getenv("TDAQ_SESSION")) {
+      session_name = s;
+    }
+
+    if (session_name.empty()) {
+      TLOG_DEBUG(1) << "session name is not given and TDAQ_SESSION variable is not set";
+      return nullptr;
+    }
+  }
+
+  try {
+    // the database implementation reads referenced objects together with the session in one operation
+    const Session * session = conf.get<Session>(session_name, false, true, rlevel, rclasses);
+
+    if (session) {
+      Prefetch(conf, rclasses).run(*session, rlevel);
+    }
+
+    return session;
+  }
+  catch (const dunedaq::conffwk::Exception& ex) {
+    throw BadSessionID(ERS_HERE, session_name, ex);
+  }
+}
+
+  // the last matching service is used, as construct_commandline_parameters() always did
+
+const dunedaq::confmodel::Service *
+dunedaq::confmodel::get_control_service(const Application& app)
+{
+  static const std::string_view suffix("_control");
+  const std::string& uid = app.UID();
+
+  const Service * control_service = nullptr;
+
+  for (auto const * s : app.get_exposes_service()) {
+    const std::string_view id(s->UID());
+    if (id.size() == uid.size() + suffix.size() && id.compare(0, uid.size(), uid) == 0 && id.substr(uid.size()) == suffix) {
+      control_service = s;
+    }
+  }
+
+  return control_service;
+}
+
+std::string
+dunedaq::confmodel::get_control_uri(const Application& app, const Service& control_service)
+{
+  return control_service.get_protocol() + "://" + app.get_runs_on()->get_runs_on()->UID() + ":" + std::to_string(control_service.get_port());
+}
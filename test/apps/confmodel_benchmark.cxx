@@ -0,0 +1,390 @@
+/**
+ * @file confmodel_benchmark.cxx
+ *
+ * Times confmodel algorithms on synthetic sessions of parameterised size
+ * and reports latency percentiles and number of memory allocations per call.
+ * Results of the algorithms are checked by export_test and launch_test.
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "logging/Logging.hpp"
+
+#include "conffwk/ConfigObject.hpp"
+#include "conffwk/Configuration.hpp"
+
+#include "confmodel/Component.hpp"
+#include "confmodel/DaqApplication.hpp"
+#include "confmodel/DaqModule.hpp"
+#include "confmodel/DetDataSender.hpp"
+#include "confmodel/DetectorStream.hpp"
+#include "confmodel/DetectorToDaqConnection.hpp"
+#include "confmodel/Jsonable.hpp"
+#include "confmodel/ResourceSet.hpp"
+#include "confmodel/Segment.hpp"
+#include "confmodel/Session.hpp"
+#include "confmodel/command-line.hpp"
+#include "confmodel/environment.hpp"
+#include "confmodel/launch-plan.hpp"
+#include "confmodel/resolved-session.hpp"
+#include "confmodel/session-generator.hpp"
+#include "confmodel/session-index.hpp"
+#include "confmodel/util.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <new>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+using namespace dunedaq;
+
+// ========================================================================
+// count memory allocations of the whole process
+
+static std::atomic<std::size_t> s_allocations{0};
+
+void* operator new(std::size_t size) {
+  ++s_allocations;
+  if (void* p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+// ========================================================================
+// measurements
+
+struct Samples {
+  std::vector<double> m_ns;
+  std::size_t m_allocations = 0;
+};
+
+template <typename F>
+Samples measure(std::size_t calls, F f) {
+  Samples samples;
+  samples.m_ns.reserve(calls);
+  const std::size_t allocations = s_allocations;
+  for (std::size_t i = 0; i < calls; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    f(i);
+    auto stop = std::chrono::steady_clock::now();
+    samples.m_ns.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+  }
+  // the samples vector is reserved in advance, so only allocations of f() are counted
+  samples.m_allocations = s_allocations - allocations;
+  return samples;
+}
+
+void report(const std::string& config, const std::string& name, Samples samples) {
+  if (samples.m_ns.empty()) {
+    return;
+  }
+
+  std::sort(samples.m_ns.begin(), samples.m_ns.end());
+  auto percentile = [&samples](double p) {
+    return samples.m_ns[std::min(samples.m_ns.size() - 1, static_cast<std::size_t>(p * samples.m_ns.size()))] / 1000.;
+  };
+
+  std::cout << std::left << std::setw(36) << config << std::setw(34) << name << std::right
+            << std::setw(9) << samples.m_ns.size() << std::fixed << std::setprecision(2)
+            << std::setw(12) << percentile(0.5) << std::setw(12) << percentile(0.9)
+            << std::setw(12) << percentile(0.99) << std::setw(14) << samples.m_ns.back() / 1000.
+            << std::setw(14) << static_cast<double>(samples.m_allocations) / samples.m_ns.size() << std::endl;
+}
+
+// re-set the relationship of the session's segment to the same value; this makes the session graph
+// and the disabled state to be calculated again on next use
+void invalidate(const confmodel::Segment* segment) {
+  conffwk::ConfigObject obj(segment->config_object());
+  std::vector<conffwk::ConfigObject> segments;
+  obj.get("segments", segments);
+  std::vector<const conffwk::ConfigObject*> refs;
+  for (const auto& s : segments) {
+    refs.push_back(&s);
+  }
+  obj.set_objs("segments", refs);
+}
+
+void collect(const confmodel::Segment* segment,
+             std::vector<const confmodel::Component*>& components,
+             std::vector<const confmodel::DetectorToDaqConnection*>& connections,
+             std::vector<const confmodel::DaqApplication*>& apps) {
+  components.push_back(segment);
+  for (auto app : segment->get_applications()) {
+    if (auto daq_app = app->cast<confmodel::DaqApplication>()) {
+      apps.push_back(daq_app);
+    }
+    if (auto rs = app->cast<confmodel::ResourceSet>()) {
+      components.push_back(rs);
+      for (auto res : rs->get_contains()) {
+        components.push_back(res);
+        if (auto d2d = res->cast<confmodel::DetectorToDaqConnection>()) {
+          connections.push_back(d2d);
+          for (auto sender : d2d->get_senders()) {
+            components.push_back(sender);
+            for (auto stream : sender->get_contains()) {
+              components.push_back(stream);
+            }
+          }
+        }
+      }
+    }
+  }
+  for (auto seg : segment->get_segments()) {
+    collect(seg, components, connections, apps);
+  }
+}
+
+// at most n evenly distributed elements
+template <typename T>
+std::vector<T> sample(const std::vector<T>& v, std::size_t n) {
+  if (v.size() <= n) {
+    return v;
+  }
+  std::vector<T> result;
+  for (std::size_t i = 0; i < n; ++i) {
+    result.push_back(v[i * v.size() / n]);
+  }
+  return result;
+}
+
+int run(const confmodel::SessionGeneratorParameters& p, const std::string& dir, unsigned int iterations) {
+  const std::string config = std::to_string(p.segments) + "seg/d" + std::to_string(p.depth) + "/" +
+                             std::to_string(p.streams) + "str/" + std::to_string(static_cast<int>(p.disabled_fraction * 1000)) + "pm";
+  const std::string file = dir + "/confmodel-benchmark-" + std::to_string(p.segments) + "-" + std::to_string(p.depth) + "-" +
+                           std::to_string(p.streams) + "-" + std::to_string(static_cast<int>(p.disabled_fraction * 1000)) + ".data.xml";
+
+  std::string session_id;
+  {
+    conffwk::Configuration db("oksconflibs");
+    auto start = std::chrono::steady_clock::now();
+    session_id = confmodel::generate_session(db, file, p);
+    std::cout << "# generated " << file << " in "
+              << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s\n";
+  }
+
+  conffwk::Configuration db("oksconflibs:" + file);
+  auto session = db.get<confmodel::Session>(session_id);
+  if (session == nullptr) {
+    std::cerr << "Session " << session_id << " not found in " << file << std::endl;
+    return 1;
+  }
+
+  auto root = session->get_segment();
+
+  // objects of the session faulted in by DAL calls one at a time or prefetched by get_session()
+  for (unsigned long rlevel : {0UL, 10UL}) {
+    conffwk::Configuration fresh_db("oksconflibs:" + file);
+    const confmodel::Session* s = nullptr;
+    if (rlevel) {
+      report(config, "get_session (rlevel " + std::to_string(rlevel) + ")", measure(1, [&](std::size_t) {
+        s = confmodel::get_session(fresh_db, session_id, rlevel);
+      }));
+    }
+    else {
+      s = fresh_db.get<confmodel::Session>(session_id);
+    }
+    report(config, std::string("walk session (") + (rlevel ? "prefetched" : "lazy") + ")", measure(1, [&](std::size_t) {
+      std::vector<const confmodel::Component*> c;
+      std::vector<const confmodel::DetectorToDaqConnection*> d;
+      std::vector<const confmodel::DaqApplication*> a;
+      collect(s->get_segment(), c, d, a);
+      for (auto app : a) {
+        app->get_modules();
+      }
+    }));
+  }
+
+  report(config, "disabled (first use)", measure(1, [&](std::size_t) { root->disabled(*session); }));
+
+  std::vector<const confmodel::Component*> components;
+  std::vector<const confmodel::DetectorToDaqConnection*> connections;
+  std::vector<const confmodel::DaqApplication*> apps;
+  collect(root, components, connections, apps);
+
+  report(config, "disabled (cold)", measure(iterations, [&](std::size_t) {
+    invalidate(root);
+    root->disabled(*session);
+  }));
+  report(config, "disabled (warm)", measure(components.size(), [&](std::size_t i) { components[i]->disabled(*session); }));
+  report(config, "get_all_applications", measure(iterations, [&](std::size_t) { session->get_all_applications(); }));
+  report(config, "get_enabled_applications", measure(iterations, [&](std::size_t) { session->get_enabled_applications(); }));
+  report(config, "get_shared_applications", measure(iterations, [&](std::size_t) { session->get_shared_applications(true); }));
+  report(config, "for_each_application", measure(iterations, [&](std::size_t) {
+    std::size_t count(0);
+    session->for_each_application([&count](const confmodel::Application&) { ++count; return true; }, true);
+  }));
+
+  const auto parents_of = sample(components, 1000);
+  report(config, "get_parents", measure(parents_of.size(), [&](std::size_t i) {
+    std::list<std::vector<const confmodel::Component*>> parents;
+    parents_of[i]->get_parents(*session, parents);
+  }));
+  report(config, "get_all_parents", measure(iterations, [&](std::size_t) {
+    std::unordered_map<const confmodel::Component*, std::list<std::vector<const confmodel::Component*>>> parents;
+    session->get_all_parents(parents);
+  }));
+
+  std::vector<const confmodel::Jsonable*> modules;
+  for (auto app : sample(apps, 250)) {
+    for (auto mod : app->get_modules()) {
+      if (auto json = mod->cast<confmodel::Jsonable>()) {
+        modules.push_back(json);
+      }
+    }
+  }
+  report(config, "to_json", measure(modules.size(), [&](std::size_t i) { modules[i]->to_json(); }));
+  confmodel::JsonOptions references;
+  references.m_references = true;
+  report(config, "to_json (references)", measure(modules.size(), [&](std::size_t i) { modules[i]->to_json_with_options(references); }));
+  confmodel::JsonOptions projection;
+  projection.m_max_depth = 1;
+  projection.m_exclude_attributes = {"gains"};
+  report(config, "to_json (depth 1)", measure(modules.size(), [&](std::size_t i) { modules[i]->to_json_with_options(projection); }));
+  report(config, "write_json", measure(modules.size(), [&](std::size_t i) {
+    std::ostringstream out;
+    modules[i]->write_json(out, confmodel::JsonOptions());
+  }));
+  confmodel::JsonSerializer serializer(db, confmodel::JsonOptions());
+  report(config, "JsonSerializer::serialize", measure(modules.size(), [&](std::size_t i) { serializer.serialize(modules[i]->config_object()); }));
+
+  for (unsigned int threads : {1, 4, 0}) {
+    report(config, "export_session (" + (threads ? std::to_string(threads) : std::string("all")) + " threads)", measure(1, [&](std::size_t) {
+      confmodel::export_session(db, *session, confmodel::JsonOptions(), threads);
+    }));
+  }
+
+  report(config, "get_streams", measure(connections.size(), [&](std::size_t i) { connections[i]->get_streams(); }));
+  report(config, "construct_commandline_parameters", measure(apps.size(), [&](std::size_t i) {
+    apps[i]->construct_commandline_parameters(db, session);
+  }));
+
+  report(config, "EnvironmentResolver::get_environments", measure(iterations, [&](std::size_t) {
+    confmodel::EnvironmentResolver(*session).get_environments();
+  }));
+  {
+    confmodel::CommandLineExpander expander(session);
+    report(config, "CommandLineExpander::expand", measure(apps.size(), [&](std::size_t i) { expander.expand(*apps[i]); }));
+  }
+  report(config, "LaunchPlan", measure(iterations, [&](std::size_t) { confmodel::LaunchPlan plan(db, *session); }));
+
+  std::string binary;
+  {
+    std::ostringstream out;
+    confmodel::write_resolved_session(confmodel::resolve_session(db, *session), out);
+    binary = out.str();
+  }
+
+  report(config, "load XML session", measure(3, [&](std::size_t) {
+    conffwk::Configuration xml_db("oksconflibs:" + file);
+    xml_db.get<confmodel::Session>(session_id)->get_enabled_applications();
+  }));
+  report(config, "resolve_session", measure(3, [&](std::size_t) { confmodel::resolve_session(db, *session); }));
+  report(config, "read_resolved_session (" + std::to_string(binary.size() / 1024) + " KiB)", measure(iterations, [&](std::size_t) {
+    std::istringstream in(binary);
+    confmodel::read_resolved_session(in);
+  }));
+
+  const std::string index_file = file + ".index";
+  report(config, "SessionIndex::write", measure(1, [&](std::size_t) { confmodel::SessionIndex::write(db, *session, index_file); }));
+  report(config, "SessionIndex (map)", measure(iterations, [&](std::size_t) { confmodel::SessionIndex index(index_file); }));
+  report(config, "SessionIndex (map and verify)", measure(iterations, [&](std::size_t) { confmodel::SessionIndex index(index_file, true); }));
+  {
+    confmodel::SessionIndex index(index_file);
+    report(config, "SessionIndex::find", measure(components.size(), [&](std::size_t i) { index.find(components[i]->UID()); }));
+  }
+
+  return 0;
+}
+
+int main(int argc, char* argv[]) {
+  confmodel::SessionGeneratorParameters params;
+  std::vector<confmodel::SessionGeneratorParameters> configs;
+  std::string dir("/tmp");
+  unsigned int iterations = 10;
+  bool custom = false, quick = false;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg(argv[i]);
+    auto value = [&]() -> std::string {
+      if (i + 1 >= argc) {
+        std::cerr << "Missing value of " << arg << std::endl;
+        std::exit(1);
+      }
+      return argv[++i];
+    };
+
+    if (arg == "--segments") { params.segments = std::stoul(value()); custom = true; }
+    else if (arg == "--depth") { params.depth = std::stoul(value()); custom = true; }
+    else if (arg == "--streams") { params.streams = std::stoul(value()); custom = true; }
+    else if (arg == "--disabled") { params.disabled_fraction = std::stod(value()); custom = true; }
+    else if (arg == "--seed") { params.seed = std::stoul(value()); }
+    else if (arg == "--iterations") { iterations = std::stoul(value()); }
+    else if (arg == "--dir") { dir = value(); }
+    else if (arg == "--quick") { quick = true; }
+    else {
+      std::cout << "Usage: " << argv[0] << " [--segments N] [--depth N] [--streams N] [--disabled fraction] [--seed N]\n"
+                   "          [--iterations N] [--dir directory] [--quick]\n\n"
+                   "Without size parameters a sweep of sessions from 10 to 10k segments and from 100 to 100k\n"
+                   "detector streams is run, with variants of nesting depth and disabled components density;\n"
+                   "--quick skips the largest session.\n";
+      return (arg == "--help" || arg == "-h") ? 0 : 1;
+    }
+  }
+
+  if (custom) {
+    configs.push_back(params);
+  }
+  else {
+    // segments, depth, streams, disabled fraction
+    const std::vector<std::tuple<unsigned int, unsigned int, unsigned int, double>> sweep{
+      {10, 2, 100, 0.01}, {100, 2, 1000, 0.01}, {1000, 3, 10000, 0.01}, {10000, 4, 100000, 0.01},
+      {1000, 1, 10000, 0.01}, {1000, 8, 10000, 0.01},
+      {1000, 3, 10000, 0.0}, {1000, 3, 10000, 0.1}};
+
+    for (const auto& s : sweep) {
+      if (quick && std::get<0>(s) > 1000) {
+        continue;
+      }
+      params.segments = std::get<0>(s);
+      params.depth = std::get<1>(s);
+      params.streams = std::get<2>(s);
+      params.disabled_fraction = std::get<3>(s);
+      configs.push_back(params);
+    }
+  }
+
+  dunedaq::logging::Logging::setup("confmodel-benchmark", "confmodel-benchmark");
+
+  std::cout << std::left << std::setw(36) << "# session" << std::setw(34) << "algorithm" << std::right
+            << std::setw(9) << "calls" << std::setw(12) << "p50 us" << std::setw(12) << "p90 us"
+            << std::setw(12) << "p99 us" << std::setw(14) << "max us" << std::setw(14) << "allocs/call" << std::endl;
+
+  for (const auto& p : configs) {
+    if (int status = run(p, dir, iterations)) {
+      return status;
+    }
+  }
+
+  return 0;
+}
@@ -10,7 +10,10 @@
 #include "confmodel/Session.hpp"
 
 #include <iostream>
+#include <list>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 using namespace dunedaq;
 
@@ -100,4 +103,49 @@ int main(int argc, char* argv[]) {
   session->set_disabled({});
   listApps(session);
 
+  std::cout << "======\nNow trying to disable and enable again each segment\n";
+  const auto enabled_apps = session->get_enabled_applications();
+  std::vector<const confmodel::Application*> visited_apps;
+  session->for_each_application([&visited_apps](const confmodel::Application& app) { visited_apps.push_back(&app); return true; }, true);
+  int failures = 0;
+  if (visited_apps != enabled_apps) {
+    std::cout << "ERROR: for_each_application() visits different applications\n";
+    ++failures;
+  }
+  std::vector<std::set<const confmodel::Component*>> candidates;
+  for (auto seg : rseg->get_segments()) {
+    candidates.push_back({seg});
+  }
+  const auto what_if = session->evaluate_disabled(candidates);
+  std::size_t idx = 0;
+  for (auto seg : rseg->get_segments()) {
+    session->disable_more({seg});
+    std::cout << "Segment " << seg->UID() << " disabled: "
+              << session->get_enabled_applications().size() << " of "
+              << enabled_apps.size() << " applications still enabled\n";
+    if (session->get_enabled_applications() != what_if[idx++].m_enabled_applications) {
+      std::cout << "ERROR: evaluate_disabled() result differs for segment " << seg->UID() << "\n";
+      ++failures;
+    }
+    session->enable_again({seg});
+    if (session->get_enabled_applications() != enabled_apps) {
+      std::cout << "ERROR: enabled applications differ after enabling again segment " << seg->UID() << "\n";
+      ++failures;
+    }
+  }
+
+  std::cout << "======\nNow comparing parents of all components with parents of each one\n";
+  std::unordered_map<const confmodel::Component*, std::list<std::vector<const confmodel::Component*>>> all_parents;
+  session->get_all_parents(all_parents);
+  for (const auto& x : all_parents) {
+    std::list<std::vector<const confmodel::Component*>> parents;
+    x.first->get_parents(*session, parents);
+    if (parents != x.second) {
+      std::cout << "ERROR: get_all_parents() result differs for " << x.first->UID() << "\n";
+      ++failures;
+    }
+  }
+  std::cout << all_parents.size() << " components checked\n";
+
+  return failures;
 }
@@ -0,0 +1,185 @@
+#include "logging/Logging.hpp"
+
+#include "conffwk/Configuration.hpp"
+
+#include "confmodel/DaqApplication.hpp"
+#include "confmodel/DaqModule.hpp"
+#include "confmodel/Jsonable.hpp"
+#include "confmodel/Session.hpp"
+#include "confmodel/json-serializer.hpp"
+#include "confmodel/resolved-session.hpp"
+#include "confmodel/session-generator.hpp"
+#include "confmodel/session-index.hpp"
+
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace dunedaq;
+
+int main(int argc, char* argv[]) {
+  std::string sessionName, file;
+  bool generated = false;
+
+  if (argc >= 3) {
+    sessionName = argv[1];
+    file = argv[2];
+  }
+  else {
+    // a small session with nested segments, variable sets, shared resource sets and disabled components
+    confmodel::SessionGeneratorParameters params;
+    params.segments = 10;
+    params.depth = 2;
+    params.streams = 100;
+    params.variable_set_depth = 2;
+    params.shared_sets = 2;
+    params.disabled_fraction = 0.1;
+    file = "/tmp/confmodel-export-test-" + std::to_string(getpid()) + ".data.xml";
+    conffwk::Configuration db("oksconflibs");
+    sessionName = confmodel::generate_session(db, file, params);
+    generated = true;
+  }
+
+  dunedaq::logging::Logging::setup(sessionName, "export-test");
+
+  conffwk::Configuration db("oksconflibs:" + file);
+
+  auto session = db.get<confmodel::Session>(sessionName);
+  if (session == nullptr) {
+    std::cerr << "Session " << sessionName << " not found in database\n";
+    return -1;
+  }
+
+  int failures = 0;
+
+  std::cout << "Comparing write_json() with to_json() for applications and modules\n";
+  std::vector<const confmodel::Jsonable*> objects;
+  for (auto app : session->get_all_applications()) {
+    if (auto json = app->cast<confmodel::Jsonable>()) {
+      objects.push_back(json);
+    }
+    if (auto daq_app = app->cast<confmodel::DaqApplication>()) {
+      for (auto mod : daq_app->get_modules()) {
+        if (auto json = mod->cast<confmodel::Jsonable>()) {
+          objects.push_back(json);
+        }
+      }
+    }
+  }
+  for (auto obj : objects) {
+    for (int indent : {-1, 4}) {
+      std::ostringstream out;
+      obj->write_json(out, confmodel::JsonOptions(), indent);
+      if (out.str() != obj->to_json().dump(indent)) {
+        std::cout << "ERROR: write_json() output differs from to_json() for " << obj->UID() << "\n";
+        ++failures;
+      }
+    }
+  }
+  std::cout << objects.size() << " objects checked\n";
+
+  std::cout << "======\nComparing parallel session export with serial one\n";
+  std::vector<std::pair<std::string, confmodel::JsonOptions>> export_options(1, {"default options", confmodel::JsonOptions()});
+  export_options.emplace_back("references", confmodel::JsonOptions());
+  export_options.back().second.m_references = true;
+  export_options.emplace_back("depth 1 and projection", confmodel::JsonOptions());
+  export_options.back().second.m_max_depth = 1;
+  export_options.back().second.m_exclude_attributes = {"gains"};
+  std::vector<const confmodel::DaqModule*> modules;
+  std::unordered_set<const confmodel::DaqModule*> known_modules;
+  for (auto app : session->get_all_applications()) {
+    if (auto daq_app = app->cast<confmodel::DaqApplication>()) {
+      for (auto mod : daq_app->get_modules()) {
+        if (known_modules.insert(mod).second) {
+          modules.push_back(mod);
+        }
+      }
+    }
+  }
+  for (const auto& x : export_options) {
+    const auto exported = confmodel::export_session(db, *session, x.second, 1);
+    const std::string serial(exported.dump());
+    // every item is serialized independently, i.e. an object written inside another item is not a reference
+    const auto& exported_modules = exported.at("modules");
+    for (std::size_t i = 0; i < modules.size(); ++i) {
+      auto json = modules[i]->cast<confmodel::Jsonable>();
+      if (json == nullptr) {
+        continue;
+      }
+      if (i >= exported_modules.size() || exported_modules[i] != json->to_json_with_options(x.second)) {
+        std::cout << "ERROR: exported module " << modules[i]->UID() << " with " << x.first << " differs from to_json_with_options()\n";
+        ++failures;
+      }
+    }
+    for (unsigned int threads : {2, 4, 0}) {
+      if (confmodel::export_session(db, *session, x.second, threads).dump() != serial) {
+        std::cout << "ERROR: export_session() with " << threads << " threads and " << x.first << " differs from serial one\n";
+        ++failures;
+      }
+      std::ostringstream out;
+      confmodel::write_session(db, *session, out, x.second, -1, threads);
+      if (out.str() != serial) {
+        std::cout << "ERROR: write_session() with " << threads << " threads and " << x.first << " differs from serial export\n";
+        ++failures;
+      }
+    }
+  }
+
+  std::cout << "======\nWriting and reading back resolved session\n";
+  const auto resolved = confmodel::resolve_session(db, *session);
+  std::ostringstream binary;
+  confmodel::write_resolved_session(resolved, binary);
+  std::istringstream in(binary.str());
+  const auto read_back = confmodel::read_resolved_session(in);
+  std::ostringstream again;
+  confmodel::write_resolved_session(read_back, again);
+  if (again.str() != binary.str()) {
+    std::cout << "ERROR: resolved session read back differs from written one\n";
+    ++failures;
+  }
+  if (read_back.m_uid != session->UID() || read_back.m_source != db.get_impl_spec() ||
+      read_back.m_schema_version != confmodel::ResolvedSession::get_schema_version()) {
+    std::cout << "ERROR: resolved session header differs: " << read_back.m_uid << ", " << read_back.m_source
+              << ", " << read_back.m_schema_version << "\n";
+    ++failures;
+  }
+
+  std::cout << "======\nComparing session index with session\n";
+  const std::string index_file = file + ".index";
+  confmodel::SessionIndex::write(db, *session, index_file);
+  {
+    confmodel::SessionIndex index(index_file, true);
+    if (!index.is_valid(db.get_impl_spec())) {
+      std::cout << "ERROR: session index is not valid for " << db.get_impl_spec() << "\n";
+      ++failures;
+    }
+    const auto enabled_apps = session->get_shared_applications(true);
+    const std::unordered_set<const confmodel::Application*> enabled(enabled_apps->begin(), enabled_apps->end());
+    const auto all_apps = session->get_shared_applications(false);
+    for (auto app : *all_apps) {
+      const auto id = index.find(app->UID());
+      if (id == confmodel::SessionIndex::npos) {
+        std::cout << "ERROR: application " << app->UID() << " is not in session index\n";
+        ++failures;
+      }
+      else if (index.is_enabled(id) != (enabled.count(app) != 0)) {
+        std::cout << "ERROR: session index enabled state differs for application " << app->UID() << "\n";
+        ++failures;
+      }
+    }
+    std::cout << all_apps->size() << " applications checked\n";
+  }
+  std::remove(index_file.c_str());
+
+  if (generated) {
+    std::remove(file.c_str());
+  }
+
+  return failures;
+}
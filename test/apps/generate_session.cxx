@@ -0,0 +1,89 @@
+#include "logging/Logging.hpp"
+
+#include "conffwk/Configuration.hpp"
+
+#include "confmodel/session-generator.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace dunedaq;
+
+int main(int argc, char* argv[]) {
+
+  confmodel::SessionGeneratorParameters params;
+  std::string file;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg(argv[i]);
+    auto value = [&]() -> unsigned int {
+      if (i + 1 >= argc) {
+        std::cerr << "Missing value of " << arg << std::endl;
+        std::exit(1);
+      }
+      return std::stoul(argv[++i]);
+    };
+
+    if (arg == "--segments") { params.segments = value(); }
+    else if (arg == "--depth") { params.depth = value(); }
+    else if (arg == "--fanout") { params.fanout = value(); }
+    else if (arg == "--apps") { params.apps_per_segment = value(); }
+    else if (arg == "--modules") { params.modules_per_app = value(); }
+    else if (arg == "--streams") { params.streams = value(); }
+    else if (arg == "--senders-per-connection") { params.senders_per_connection = value(); }
+    else if (arg == "--streams-per-sender") { params.streams_per_sender = value(); }
+    else if (arg == "--variable-set-depth") { params.variable_set_depth = value(); }
+    else if (arg == "--variables-per-set") { params.variables_per_set = value(); }
+    else if (arg == "--shared-sets") { params.shared_sets = value(); }
+    else if (arg == "--streams-per-shared-set") { params.streams_per_shared_set = value(); }
+    else if (arg == "--parents-per-shared-set") { params.parents_per_shared_set = value(); }
+    else if (arg == "--disabled") {
+      if (i + 1 >= argc) {
+        std::cerr << "Missing value of " << arg << std::endl;
+        return 1;
+      }
+      params.disabled_fraction = std::stod(argv[++i]);
+    }
+    else if (arg == "--seed") { params.seed = value(); }
+    else if (file.empty() && !arg.empty() && arg[0] != '-') { file = arg; }
+    else {
+      file.clear();
+      break;
+    }
+  }
+
+  if (file.empty()) {
+    std::cout << "Usage: " << argv[0] << " [options] database-file\n\n"
+                 "Writes a synthetic session for scale testing; the same options always give the same file.\n\n"
+                 "  --segments N                  total number of segments (" << params.segments << ")\n"
+                 "  --depth N                     maximum nesting level of segments (" << params.depth << ")\n"
+                 "  --fanout N                    nested segments per segment; builds full tree ignoring --segments\n"
+                 "  --apps N                      DaqApplications per segment (" << params.apps_per_segment << ")\n"
+                 "  --modules N                   modules per DaqApplication (" << params.modules_per_app << ")\n"
+                 "  --streams N                   total number of detector streams (" << params.streams << ")\n"
+                 "  --senders-per-connection N    senders per DetectorToDaqConnection (" << params.senders_per_connection << ")\n"
+                 "  --streams-per-sender N        streams per sender (" << params.streams_per_sender << ")\n"
+                 "  --variable-set-depth N        nesting of environment VariableSets (" << params.variable_set_depth << ")\n"
+                 "  --variables-per-set N         variables per VariableSet (" << params.variables_per_set << ")\n"
+                 "  --shared-sets N               resource sets shared by readout applications (" << params.shared_sets << ")\n"
+                 "  --streams-per-shared-set N    streams per shared resource set (" << params.streams_per_shared_set << ")\n"
+                 "  --parents-per-shared-set N    readout applications per shared resource set (" << params.parents_per_shared_set << ")\n"
+                 "  --disabled fraction           fraction of components disabled in session (" << params.disabled_fraction << ")\n"
+                 "  --seed N                      random generator seed (" << params.seed << ")\n";
+    return 1;
+  }
+
+  dunedaq::logging::Logging::setup("generate-session", "generate-session");
+
+  try {
+    conffwk::Configuration db("oksconflibs");
+    std::cout << confmodel::generate_session(db, file, params) << std::endl;
+  }
+  catch (const dunedaq::conffwk::Exception& ex) {
+    std::cerr << "Failed to generate session: " << ex << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
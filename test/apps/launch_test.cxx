@@ -0,0 +1,136 @@
+#include "logging/Logging.hpp"
+
+#include "conffwk/Configuration.hpp"
+
+#include "confmodel/Application.hpp"
+#include "confmodel/DaqApplication.hpp"
+#include "confmodel/RCApplication.hpp"
+#include "confmodel/Session.hpp"
+#include "confmodel/Variable.hpp"
+#include "confmodel/VariableBase.hpp"
+#include "confmodel/VariableSet.hpp"
+#include "confmodel/command-line.hpp"
+#include "confmodel/environment.hpp"
+#include "confmodel/launch-plan.hpp"
+#include "confmodel/session-generator.hpp"
+#include "confmodel/util.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace dunedaq;
+
+// straightforward flattening of variables: depth-first, the first definition of a name is used
+void flatten(const std::vector<const confmodel::VariableBase*>& variables, confmodel::EnvironmentResolver::Environment& env) {
+  for (auto v : variables) {
+    if (auto var = v->cast<confmodel::Variable>()) {
+      env.emplace(var->get_name(), var->get_value());
+    }
+    else if (auto set = v->cast<confmodel::VariableSet>()) {
+      flatten(set->get_contains(), env);
+    }
+  }
+}
+
+int main(int argc, char* argv[]) {
+  std::string sessionName, file;
+  bool generated = false;
+
+  if (argc >= 3) {
+    sessionName = argv[1];
+    file = argv[2];
+  }
+  else {
+    // a small session with nested variable sets and command line parameters using variables
+    confmodel::SessionGeneratorParameters params;
+    params.segments = 10;
+    params.depth = 2;
+    params.streams = 100;
+    params.variable_set_depth = 3;
+    params.disabled_fraction = 0.1;
+    file = "/tmp/confmodel-launch-test-" + std::to_string(getpid()) + ".data.xml";
+    conffwk::Configuration db("oksconflibs");
+    sessionName = confmodel::generate_session(db, file, params);
+    generated = true;
+  }
+
+  dunedaq::logging::Logging::setup(sessionName, "launch-test");
+
+  conffwk::Configuration db("oksconflibs:" + file);
+
+  auto session = db.get<confmodel::Session>(sessionName);
+  if (session == nullptr) {
+    std::cerr << "Session " << sessionName << " not found in database\n";
+    return -1;
+  }
+
+  int failures = 0;
+
+  std::cout << "Comparing launch plan with command lines of each application\n";
+  confmodel::LaunchPlan plan(db, *session);
+  for (const auto& entry : plan.get_entries()) {
+    std::vector<std::string> expected;
+    if (auto rc = entry.m_application->cast<confmodel::RCApplication>()) {
+      expected = rc->construct_commandline_parameters(db, session);
+    }
+    else if (auto daq_app = entry.m_application->cast<confmodel::DaqApplication>()) {
+      expected = daq_app->construct_commandline_parameters(db, session);
+    }
+    else {
+      expected = entry.m_application->expand_commandline_parameters(*session);
+    }
+    if (entry.get_arguments() != expected) {
+      std::cout << "ERROR: launch plan arguments differ for " << entry.m_application->UID() << "\n";
+      ++failures;
+    }
+  }
+  std::cout << plan.get_entries().size() << " applications checked\n";
+
+  std::cout << "======\nComparing resolved environments with flattened variables of each application\n";
+  const auto environments = confmodel::EnvironmentResolver(*session).get_environments();
+  for (const auto& x : environments) {
+    confmodel::EnvironmentResolver::Environment expected;
+    flatten(x.first->get_application_environment(), expected);
+    flatten(session->get_environment(), expected);
+    if (*x.second != expected) {
+      std::cout << "ERROR: environment differs for " << x.first->UID() << "\n";
+      ++failures;
+    }
+  }
+  std::cout << environments.size() << " applications checked\n";
+
+  std::cout << "======\nComparing expanded command line parameters with and without explicit session\n";
+  confmodel::CommandLineExpander expander(session);
+  const auto apps = session->get_shared_applications(true);
+  setenv("TDAQ_SESSION", sessionName.c_str(), 1);
+  for (auto app : *apps) {
+    const auto parameters = app->expand_commandline_parameters(*session);
+    if (app->parse_commandline_parameters() != parameters || expander.expand(*app) != parameters) {
+      std::cout << "ERROR: expanded command line parameters differ for " << app->UID() << "\n";
+      ++failures;
+    }
+  }
+  unsetenv("TDAQ_SESSION");
+  if (!apps->empty()) {
+    try {
+      apps->front()->parse_commandline_parameters();
+      std::cout << "ERROR: parse_commandline_parameters() did not fail without TDAQ_SESSION\n";
+      ++failures;
+    }
+    catch (const confmodel::BadApplicationInfo&) {
+      ;
+    }
+  }
+  std::cout << apps->size() << " applications checked\n";
+
+  if (generated) {
+    std::remove(file.c_str());
+  }
+
+  return failures;
+}
@@ -0,0 +1,57 @@
+#ifndef DUNEDAQDAL_SESSION_GENERATOR_H
+#define DUNEDAQDAL_SESSION_GENERATOR_H
+
+#include <string>
+
+namespace dunedaq::conffwk {
+    class Configuration;
+}
+
+namespace dunedaq::confmodel {
+
+    /**
+     *  \brief Parameters of a synthetic session.
+     *
+     *  The same parameters and seed always give the same database contents.
+     */
+
+    struct SessionGeneratorParameters
+    {
+      unsigned int segments = 100;              // total number of segments including the session's one
+      unsigned int depth = 3;                   // maximum nesting level of segments
+      unsigned int fanout = 0;                  // nested segments per segment; if set, the tree is full and segments is ignored
+      unsigned int apps_per_segment = 2;        // DaqApplications per segment, in addition to the controller and readout one
+      unsigned int modules_per_app = 4;         // modules per DaqApplication
+      unsigned int streams = 1000;              // total number of DetectorStreams, evenly distributed between segments
+      unsigned int senders_per_connection = 2;  // DetDataSenders per DetectorToDaqConnection
+      unsigned int streams_per_sender = 4;      // DetectorStreams per DetDataSender
+      unsigned int variable_set_depth = 0;      // nesting of VariableSets used as session and applications environment
+      unsigned int variables_per_set = 4;
+      unsigned int shared_sets = 0;             // resource-set-OR of streams shared by several readout applications
+      unsigned int streams_per_shared_set = 4;
+      unsigned int parents_per_shared_set = 2;
+      double disabled_fraction = 0.01;          // fraction of segments, readout applications, senders and streams in Session.disabled
+      unsigned int seed = 1;
+    };
+
+    /**
+     *  \brief Create database file with synthetic session for scale testing.
+     *
+     *  The file includes test/schema/confmodel/synthetic.schema.xml (by its path in the source tree, the schema
+     *  is not installed) providing concrete classes for abstract detector data senders, receivers and DAQ modules;
+     *  the database is committed.
+     *
+     *  \param db      configuration object (e.g. created with "oksconflibs" implementation)
+     *  \param file    name of the data file to be created
+     *  \param params  the session parameters
+     *
+     *  \return Returns the UID of the created session.
+     *  \throw dunedaq::conffwk::Exception on database errors
+     */
+
+    std::string
+    generate_session(dunedaq::conffwk::Configuration& db, const std::string& file, const SessionGeneratorParameters& params);
+
+} // namespace dunedaq::confmodel
+
+#endif // DUNEDAQDAL_SESSION_GENERATOR_H
@@ -0,0 +1,383 @@
+#include "confmodel/session-generator.hpp"
+
+#include "conffwk/ConfigObject.hpp"
+#include "conffwk/Configuration.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+  // the test schema is not installed with the package, its path in the source tree is set by the build
+
+#ifndef CONFMODEL_SYNTHETIC_SCHEMA
+#error "CONFMODEL_SYNTHETIC_SCHEMA is not defined"
+#endif
+
+using namespace dunedaq::conffwk;
+using namespace dunedaq::confmodel;
+
+namespace {
+
+  class SessionGenerator
+  {
+
+  public:
+
+    SessionGenerator(Configuration& db, const std::string& file, const SessionGeneratorParameters& params) :
+      m_db(db),
+      m_file(file),
+      m_params(params),
+      m_segments(params.segments),
+      m_random(params.seed)
+    {
+      if (m_params.fanout) {
+        m_segments = 1;
+        for (unsigned int i = 0, level = 1; i < m_params.depth; ++i) {
+          level *= m_params.fanout;
+          m_segments += level;
+        }
+      }
+
+      if (m_segments == 0) {
+        m_segments = 1;
+      }
+    }
+
+    std::string
+    generate()
+    {
+      m_db.create(m_file, {CONFMODEL_SYNTHETIC_SCHEMA});
+
+      auto& host = create("PhysicalHost", "host-0");
+      auto& cpu = create("ProcessingResource", "cpu-0");
+      std::vector<uint16_t> cores{0, 1};
+      cpu.set_by_ref("cpu_cores", cores);
+      host.set_objs("contains", {&cpu});
+
+      m_vhost = &create("VirtualHost", "vhost-0");
+      m_vhost->set_objs("uses", {&cpu});
+      m_vhost->set_obj("runs_on", &host);
+
+      m_opmon_conf = &create("OpMonConf", "opmon-conf");
+
+      auto& transition = create("FSMtransition", "fsm-transition-conf");
+      transition.set_by_val<std::string>("source", "initial");
+      transition.set_by_val<std::string>("dest", "configured");
+      m_fsm = &create("FSMconfiguration", "fsm");
+      m_fsm->set_objs("transitions", {&transition});
+
+      // applications override some of the session variables
+      m_app_environment = create_variable_sets("app-env", "application");
+      auto session_environment = create_variable_sets("session-env", "session");
+
+      const unsigned int fanout = get_fanout();
+
+      std::vector<std::pair<ConfigObject *, unsigned int>> queue;
+      std::vector<std::vector<const ConfigObject *>> subsegments;
+      queue.emplace_back(&create_segment(0), 0);
+      subsegments.emplace_back();
+      unsigned int created = 1;
+
+      // breadth-first, so the tree is as balanced as possible
+      for (std::size_t idx = 0; idx < queue.size() && created < m_segments; ++idx) {
+        if (queue[idx].second < m_params.depth) {
+          for (unsigned int i = 0; i < fanout && created < m_segments; ++i) {
+            auto& seg = create_segment(created++);
+            subsegments[idx].push_back(&seg);
+            queue.emplace_back(&seg, queue[idx].second + 1);
+            subsegments.emplace_back();
+          }
+        }
+      }
+
+      for (std::size_t idx = 0; idx < queue.size(); ++idx) {
+        queue[idx].first->set_objs("segments", subsegments[idx]);
+      }
+
+      create_shared_sets();
+
+      for (auto& r : m_readout_apps) {
+        r.first->set_objs("contains", r.second);
+      }
+
+      auto& opmon_uri = create("OpMonURI", "opmon-uri");
+      auto& detector_config = create("DetectorConfig", "detector-config");
+
+      const std::string session_id("synthetic-session");
+      auto& session = create("Session", session_id);
+      session.set_obj("segment", queue.front().first);
+      session.set_obj("opmon_uri", &opmon_uri);
+      session.set_obj("detector_configuration", &detector_config);
+      session.set_objs("environment", session_environment);
+      session.set_objs("disabled", m_disabled);
+
+      m_db.commit("synthetic session");
+
+      TLOG_DEBUG(1) << "generated session " << session_id << " with " << queue.size() << " segments, " << m_num_of_apps
+                    << " applications, " << m_streams.size() << " detector streams and " << m_disabled.size()
+                    << " disabled components (" << m_objects.size() << " objects) in file " << m_file;
+
+      return session_id;
+    }
+
+  private:
+
+    // the smallest fan-out giving the requested number of segments at the requested depth
+    unsigned int
+    get_fanout() const
+    {
+      if (m_params.fanout) {
+        return m_params.fanout;
+      }
+
+      if (m_params.depth == 0) {
+        return 0;
+      }
+
+      auto capacity = [this](unsigned int fanout) {
+        std::size_t total(0), level(1);
+        for (unsigned int i = 0; i < m_params.depth && total < m_segments; ++i) {
+          level *= fanout;
+          total += level;
+        }
+        return total;
+      };
+
+      unsigned int fanout = 1;
+      while (capacity(fanout) < m_segments - 1) {
+        fanout++;
+      }
+
+      return fanout;
+    }
+
+    ConfigObject&
+    create(const std::string& class_name, const std::string& id)
+    {
+      m_objects.emplace_back();
+      m_db.create(m_file, class_name, id, m_objects.back());
+      return m_objects.back();
+    }
+
+    // the raw generator output is the same on any platform, unlike std distributions
+
+    bool
+    draw(double fraction)
+    {
+      return (m_random() < fraction * 4294967296.0);
+    }
+
+    std::size_t
+    pick(std::size_t size)
+    {
+      return (m_random() % size);
+    }
+
+    void
+    maybe_disable(const ConfigObject& obj)
+    {
+      if (draw(m_params.disabled_fraction)) {
+        m_disabled.push_back(&obj);
+      }
+    }
+
+    // chain of nested variable sets; variables of a level may reference ones of the same level
+    std::vector<const ConfigObject *>
+    create_variable_sets(const std::string& prefix, const std::string& owner)
+    {
+      if (m_params.variable_set_depth == 0) {
+        return {};
+      }
+
+      const ConfigObject * nested(nullptr);
+
+      for (unsigned int level = m_params.variable_set_depth; level-- > 0;) {
+        auto& set = create("VariableSet", prefix + "-" + std::to_string(level));
+        std::vector<const ConfigObject *> contains;
+
+        for (unsigned int i = 0; i < std::max(1U, m_params.variables_per_set); ++i) {
+          std::string name("VAR_" + std::to_string(level) + "_" + std::to_string(i));
+          std::string value(i == 0 ? owner + "-" + std::to_string(level) : "${VAR_" + std::to_string(level) + "_0}/" + std::to_string(i));
+          auto& var = create("Variable", prefix + "-" + std::to_string(level) + "-" + std::to_string(i));
+          var.set_by_ref("name", name);
+          var.set_by_ref("value", value);
+          contains.push_back(&var);
+        }
+
+        if (nested) {
+          contains.push_back(nested);
+        }
+
+        set.set_objs("contains", contains);
+        nested = &set;
+      }
+
+      return {nested};
+    }
+
+    ConfigObject&
+    create_app(const std::string& class_name, const std::string& id)
+    {
+      auto& app = create(class_name, id);
+      auto& control = create("Service", id + "_control");
+      control.set_by_val<uint16_t>("port", static_cast<uint16_t>(5000 + m_num_of_apps++ % 10000));
+      app.set_obj("runs_on", m_vhost);
+      app.set_obj("opmon_conf", m_opmon_conf);
+      app.set_objs("exposes_service", {&control});
+      app.set_objs("application_environment", m_app_environment);
+      std::vector<std::string> parameters{"--session", "${DUNEDAQ_SESSION}", "--label=" + id + "-${VAR_0_0}"};
+      app.set_by_ref("commandline_parameters", parameters);
+      return app;
+    }
+
+    void
+    add_modules(ConfigObject& app, const std::string& id)
+    {
+      std::vector<const ConfigObject *> modules;
+
+      for (unsigned int i = 0; i < m_params.modules_per_app; ++i) {
+        auto& mod = create("SyntheticModule", id + "-mod-" + std::to_string(i));
+        mod.set_by_val<uint32_t>("threshold", i);
+        std::vector<uint16_t> gains{1, 2, 4};
+        mod.set_by_ref("gains", gains);
+        modules.push_back(&mod);
+      }
+
+      app.set_objs("modules", modules);
+    }
+
+    // streams of given segment: the remainder of the division is given to the first segments
+    unsigned int
+    num_of_streams(unsigned int idx) const
+    {
+      return m_params.streams / m_segments + (idx < m_params.streams % m_segments ? 1 : 0);
+    }
+
+    ConfigObject&
+    create_segment(unsigned int idx)
+    {
+      const std::string id("seg-" + std::to_string(idx));
+      auto& seg = create("Segment", id);
+
+      auto& controller = create_app("RCApplication", id + "-controller");
+      controller.set_obj("fsm", m_fsm);
+      seg.set_obj("controller", &controller);
+
+      std::vector<const ConfigObject *> apps;
+
+      for (unsigned int i = 0; i < m_params.apps_per_segment; ++i) {
+        const std::string app_id(id + "-app-" + std::to_string(i));
+        auto& app = create_app("DaqApplication", app_id);
+        add_modules(app, app_id);
+        apps.push_back(&app);
+      }
+
+      if (unsigned int streams = num_of_streams(idx)) {
+        const std::string app_id(id + "-readout");
+        auto& app = create_app("SyntheticReadoutApplication", app_id);
+        add_modules(app, app_id);
+
+        std::vector<const ConfigObject *> connections;
+
+        for (unsigned int c = 0; streams > 0; ++c) {
+          const std::string d2d_id(app_id + "-d2d-" + std::to_string(c));
+          auto& d2d = create("DetectorToDaqConnection", d2d_id);
+          std::vector<const ConfigObject *> contains{&create("SyntheticDetDataReceiver", d2d_id + "-receiver")};
+
+          for (unsigned int s = 0; s < std::max(1U, m_params.senders_per_connection) && streams > 0; ++s) {
+            auto& sender = create("SyntheticDetDataSender", d2d_id + "-sender-" + std::to_string(s));
+            std::vector<const ConfigObject *> sender_streams;
+
+            for (unsigned int i = 0; i < std::max(1U, m_params.streams_per_sender) && streams > 0; ++i, --streams) {
+              const uint32_t source_id(m_streams.size());
+              auto& geo = create("GeoId", "geo-" + std::to_string(source_id));
+              geo.set_by_val<uint32_t>("detector_id", 3);
+              geo.set_by_val<uint32_t>("crate_id", idx);
+              geo.set_by_val<uint32_t>("slot_id", c);
+              geo.set_by_val<uint32_t>("stream_id", source_id);
+              auto& stream = create("DetectorStream", "stream-" + std::to_string(source_id));
+              stream.set_by_val<uint32_t>("source_id", source_id);
+              stream.set_obj("geo_id", &geo);
+              sender_streams.push_back(&stream);
+              m_streams.push_back(&stream);
+              maybe_disable(stream);
+            }
+
+            sender.set_objs("contains", sender_streams);
+            contains.push_back(&sender);
+            maybe_disable(sender);
+          }
+
+          d2d.set_objs("contains", contains);
+          connections.push_back(&d2d);
+        }
+
+        // the contains relationship is set after shared resource sets are added
+        m_readout_apps.emplace_back(&app, std::move(connections));
+        apps.push_back(&app);
+        maybe_disable(app);
+      }
+
+      seg.set_objs("applications", apps);
+
+      if (idx != 0) {
+        maybe_disable(seg);
+      }
+
+      return seg;
+    }
+
+    // resource sets referenced by several readout applications make the session graph a DAG
+    void
+    create_shared_sets()
+    {
+      if (m_streams.empty() || m_readout_apps.empty()) {
+        return;
+      }
+
+      for (unsigned int k = 0; k < m_params.shared_sets; ++k) {
+        auto& set = create("ResourceSetOR", "shared-set-" + std::to_string(k));
+
+        std::vector<const ConfigObject *> contains;
+        for (unsigned int i = 0; i < std::max(1U, m_params.streams_per_shared_set); ++i) {
+          contains.push_back(m_streams[pick(m_streams.size())]);
+        }
+        set.set_objs("contains", contains);
+
+        const std::size_t first = pick(m_readout_apps.size());
+        for (unsigned int i = 0; i < std::max(1U, m_params.parents_per_shared_set) && i < m_readout_apps.size(); ++i) {
+          m_readout_apps[(first + i) % m_readout_apps.size()].second.push_back(&set);
+        }
+      }
+    }
+
+    Configuration& m_db;
+    const std::string m_file;
+    const SessionGeneratorParameters m_params;
+    unsigned int m_segments;
+    std::mt19937 m_random;
+    std::list<ConfigObject> m_objects; // stable addresses for relationships
+    std::vector<const ConfigObject *> m_disabled;
+    std::vector<const ConfigObject *> m_streams;
+    std::vector<std::pair<ConfigObject *, std::vector<const ConfigObject *>>> m_readout_apps;
+    std::vector<const ConfigObject *> m_app_environment;
+    ConfigObject * m_vhost = nullptr;
+    ConfigObject * m_opmon_conf = nullptr;
+    ConfigObject * m_fsm = nullptr;
+    unsigned int m_num_of_apps = 0;
+
+  };
+
+}
+
+std::string
+dunedaq::confmodel::generate_session(Configuration& db, const std::string& file, const SessionGeneratorParameters& params)
+{
+  return SessionGenerator(db, file, params).generate();
+}